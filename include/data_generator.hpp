@@ -0,0 +1,33 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef DATA_GENERATOR_H
+#define DATA_GENERATOR_H
+
+#include <string>
+
+#include "opencl_include.hpp"
+#include "hdf5_io.hpp"
+#include "ocl_dev_mgr.hpp"
+
+
+// Settings of a dataset generated on the device instead of being read from
+// the input file. The values depend only on the settings and the index of an
+// element, not on the device or the work group size.
+struct data_generator {
+  std::string distribution; // "uniform", "normal", "iota", or "linear"
+  cl_ulong seed;            // key of the random number generator
+  double param1;            // min (uniform), mean (normal), or start (iota, linear)
+  double param2;            // max (uniform), stddev (normal), or stop (linear)
+};
+
+// check whether a dataset is generated on the device, i.e. has an attribute `generator`
+bool check_generator(char const* filename, char const* varname);
+
+// read the generator settings from the attributes of a dataset
+bool read_generator(char const* filename, char const* varname, data_generator& generator);
+
+// fill the first `size` elements of `buffer` using `generator`
+bool run_generator(ocl_dev_mgr& dev_mgr, data_generator const& generator, HD5_Type type, cl::Buffer& buffer, size_t size);
+
+
+#endif // DATA_GENERATOR_H
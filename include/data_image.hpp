@@ -0,0 +1,38 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef DATA_IMAGE_H
+#define DATA_IMAGE_H
+
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "hdf5_io.hpp"
+
+
+// Settings of a dataset bound to a kernel argument of type `image2d_t` or
+// `image3d_t` instead of a buffer. Images are declared by the string attribute
+// `image_channel_order` of a dataset, e.g. "RGBA", and optionally the string
+// attribute `image_channel_type`, e.g. "unorm_int8". The dimensions of the
+// dataset are height x width (x channels) or depth x height x width (x channels).
+struct data_image {
+  cl::ImageFormat format;
+  size_t channels;
+  size_t width;
+  size_t height;
+  size_t depth; // one for two dimensional images
+};
+
+// check whether a dataset is used as an image, i.e. has an attribute `image_channel_order`
+bool check_image(char const* filename, char const* varname);
+
+// read the image settings of a dataset of type `type` with dimensions `dims`
+bool read_image(char const* filename, char const* varname, HD5_Type type, std::vector<size_t> const& dims, data_image& image);
+
+// create an image with the given access and copy `data` (if not null) to it
+cl::Memory create_image(cl::Context& context, cl::CommandQueue& queue, cl_mem_flags flags, data_image const& image, void const* data);
+
+// copy the content of an image created by `create_image` to `data`
+void read_image_data(cl::CommandQueue& queue, cl::Memory const& memory, data_image const& image, void* data);
+
+
+#endif // DATA_IMAGE_H
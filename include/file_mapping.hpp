@@ -0,0 +1,41 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef FILE_MAPPING_H
+#define FILE_MAPPING_H
+
+#include <cstdint>
+#include <vector>
+
+
+// Regions of files mapped into memory, e.g. the raw data of contiguous datasets
+// given by `h5_get_raw_data_offset`, so that they can be transferred to the
+// device without copying them to staging memory first. The mappings are
+// private (copy on write), so the files are never modified, and advised for
+// sequential access. All regions are unmapped when the mapper is destroyed.
+class file_mapper {
+public:
+  file_mapper() = default;
+  ~file_mapper();
+
+  file_mapper(file_mapper const&) = delete;
+  file_mapper& operator=(file_mapper const&) = delete;
+
+  // map `size` bytes at `offset` of a file; nullptr if not possible
+  uint8_t* map(char const* filename, size_t offset, size_t size);
+  // unmap a region obtained by `map`
+  void unmap(uint8_t* ptr);
+
+private:
+  struct region {
+    uint8_t* ptr;  // start of the mapped data
+    void* base;    // start of the mapping, aligned to the mapping granularity
+    size_t length; // length of the mapping
+  };
+
+  void unmap_region(region& reg);
+
+  std::vector<region> regions;
+};
+
+
+#endif // FILE_MAPPING_H
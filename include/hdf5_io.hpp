@@ -3,19 +3,72 @@
 #ifndef HDF5_IO_H
 #define HDF5_IO_H
 
+#include <string>
+#include <vector>
+
 #include "hdf5.h"
 #include "hdf5_hl.h"
 
 #include "opencl_include.hpp"
 
 
-enum HD5_Type { H5_float, H5_double, H5_char, H5_uchar, H5_short, H5_ushort, H5_int, H5_uint, H5_long, H5_ulong };
+// H5_half is the IEEE 754 half precision type `half` of OpenCL C (stored as cl_half)
+enum HD5_Type { H5_float, H5_double, H5_char, H5_uchar, H5_short, H5_ushort, H5_int, H5_uint, H5_long, H5_ulong, H5_half, H5_compound };
+
+// size in bytes of a single element of the given type
+size_t get_type_size(HD5_Type type);
+
+
+// An HDF5 file kept open during the lifetime of the session. While a session
+// exists, the h5_* functions called with its file name use the open file instead
+// of opening and closing the file on every call, so that the metadata cache of
+// HDF5 stays warm. Sessions of writable files create the file if necessary.
+class h5_file_session
+{
+public:
+  h5_file_session(std::string const& filename, bool writable);
+  ~h5_file_session();
+
+  h5_file_session(h5_file_session const&) = delete;
+  h5_file_session& operator=(h5_file_session const&) = delete;
+
+  // write all buffered data to the file
+  bool flush() const;
+
+  hid_t id() const { return file_id; }
+  bool is_writable() const { return writable; }
+  std::string const& filename() const { return name; }
+
+private:
+  std::string name;
+  bool writable;
+  hid_t file_id;
+};
+
+// check whether a file is kept open by a session, regardless of the spelling of its name
+bool h5_has_session(char const* filename);
+
+// the absolute path of an existing file with symbolic links resolved; otherwise the name itself
+std::string h5_absolute_path(char const* filename);
 
 
 bool h5_check_object(char const* filename, char const* varname);
 
 bool h5_get_content(char const* filename, char const* hdf_dir,
   std::vector<std::string>& data_names, std::vector<HD5_Type>& data_types, std::vector<size_t>& data_sizes);
+// additionally get the dimensions of all datasets, slowest varying dimension first
+bool h5_get_content(char const* filename, char const* hdf_dir,
+  std::vector<std::string>& data_names, std::vector<HD5_Type>& data_types, std::vector<size_t>& data_sizes,
+  std::vector<std::vector<size_t>>& data_dims);
+
+// get the names of all groups in `hdf_dir`, e.g. sparse matrices in "/data/"
+bool h5_get_groups(char const* filename, char const* hdf_dir, std::vector<std::string>& group_names);
+
+// For every dataset in `data_names`, get the index of the first dataset
+// referring to the same object, e.g. via hard or soft links.
+bool h5_get_aliases(char const* filename, std::vector<std::string> const& data_names, std::vector<size_t>& data_aliases);
+// as above, where dataset `data_names[i]` is read from the file `data_files[i]`
+bool h5_get_aliases(std::vector<std::string> const& data_files, std::vector<std::string> const& data_names, std::vector<size_t>& data_aliases);
 
 bool h5_create_dir(char const* filename, char const* hdf_dir);
 inline bool h5_create_dir(std::string const& filename, char const* hdf_dir)
@@ -23,11 +76,93 @@ inline bool h5_create_dir(std::string const& filename, char const* hdf_dir)
   return h5_create_dir(filename.c_str(), hdf_dir);
 }
 
+// create a link `varname` in `filename` pointing to `target_varname` in `target_filename`
+bool h5_create_external_link(char const* filename, char const* varname, char const* target_filename, char const* target_varname);
+inline bool h5_create_external_link(std::string const& filename, char const* varname, char const* target_filename, char const* target_varname)
+{
+  return h5_create_external_link(filename.c_str(), varname, target_filename, target_varname);
+}
+
+// copy the dataset or group `source_varname` of `source_filename` to `varname` in `filename`
+bool h5_copy_object(char const* filename, char const* varname, char const* source_filename, char const* source_varname);
+inline bool h5_copy_object(std::string const& filename, char const* varname, char const* source_filename, char const* source_varname)
+{
+  return h5_copy_object(filename.c_str(), varname, source_filename, source_varname);
+}
+
+// Create the file `merged_filename` combining a stack of files, where objects of
+// later files shadow objects of the same name in earlier files. Groups present in
+// several files are merged; all other objects are external links to the files
+// defining them. Afterwards, every setting `name=value` of `settings` replaces the
+// dataset `name` by `value`, e.g. `settings/global_range=64,1,1`.
+bool h5_merge_files(std::vector<std::string> const& filenames, std::vector<std::string> const& settings,
+                    char const* merged_filename);
+
+
+// create a link `varname` in `filename` pointing to the object `target_varname` in the same file
+bool h5_create_hard_link(char const* filename, char const* varname, char const* target_varname);
+inline bool h5_create_hard_link(std::string const& filename, char const* varname, char const* target_varname)
+{
+  return h5_create_hard_link(filename.c_str(), varname, target_varname);
+}
+
+// create a dataset `varname` in `filename` whose data are stored in the raw file
+// `external_filename` starting at byte `offset` (external storage of HDF5);
+// relative names are resolved by the readers here relative to the directory of
+// `filename`; other readers need H5Pset_efile_prefix(dapl, "${ORIGIN}") or
+// HDF5_EXTFILE_PREFIX='${ORIGIN}', else HDF5 uses their working directory
+bool h5_create_external_dataset(char const* filename, char const* varname, HD5_Type type, std::vector<size_t> const& dims,
+  char const* external_filename, size_t offset);
+inline bool h5_create_external_dataset(std::string const& filename, char const* varname, HD5_Type type, std::vector<size_t> const& dims,
+  char const* external_filename, size_t offset)
+{
+  return h5_create_external_dataset(filename.c_str(), varname, type, dims, external_filename, offset);
+}
+
+
+// reading and writing string attributes attached to an object
+bool h5_check_attribute(char const* filename, char const* varname, char const* attr_name);
+bool h5_read_attribute_string(char const* filename, char const* varname, char const* attr_name, std::string& value);
+bool h5_write_attribute_string(char const* filename, char const* varname, char const* attr_name, std::string const& value);
+
+inline bool h5_check_attribute(std::string const& filename, char const* varname, char const* attr_name)
+{
+  return h5_check_attribute(filename.c_str(), varname, attr_name);
+}
+inline bool h5_read_attribute_string(std::string const& filename, char const* varname, char const* attr_name, std::string& value)
+{
+  return h5_read_attribute_string(filename.c_str(), varname, attr_name, value);
+}
+inline bool h5_write_attribute_string(std::string const& filename, char const* varname, char const* attr_name, std::string const& value)
+{
+  return h5_write_attribute_string(filename.c_str(), varname, attr_name, value);
+}
+
+// reading and writing scalar numeric attributes attached to an object
+template<typename TYPE>
+bool h5_read_attribute(char const* filename, char const* varname, char const* attr_name, TYPE& value);
+template<typename TYPE>
+bool h5_write_attribute(char const* filename, char const* varname, char const* attr_name, TYPE value);
+
+template<typename TYPE>
+inline bool h5_read_attribute(std::string const& filename, char const* varname, char const* attr_name, TYPE& value)
+{
+  return h5_read_attribute<TYPE>(filename.c_str(), varname, attr_name, value);
+}
+template<typename TYPE>
+inline bool h5_write_attribute(std::string const& filename, char const* varname, char const* attr_name, TYPE value)
+{
+  return h5_write_attribute<TYPE>(filename.c_str(), varname, attr_name, value);
+}
+
 
 // convert a C type TYPE to the HDF5 identifier of that type
 template<typename TYPE>
 hid_t type_to_h5_type(void);
 
+// convert an HD5_Type to the HDF5 identifier of that type
+hid_t type_to_h5_type(HD5_Type type);
+
 // get the size of an OpenCL vector type
 template<typename TYPE>
 constexpr size_t get_vector_size();
@@ -43,6 +178,39 @@ inline bool h5_read_buffer(std::string const& filename, char const* varname, TYP
   return h5_read_buffer<TYPE>(filename.c_str(), varname, data);
 }
 
+// Filters applied to the chunks of the datasets written by the h5_* functions,
+// given as comma separated list, e.g. "shuffle,deflate:1". Available are
+// "none", "deflate:level" (1-9), "shuffle", "scaleoffset" (lossless for integer
+// types; "scaleoffset:digits" keeps `digits` decimal digits of floating point
+// values), the plugins "lzf", "blosc", "bzip2", "lz4", "zstd", and "bitshuffle",
+// and any other plugin by its identifier, e.g. "filter:32015:3". Parameters of
+// plugins follow their name, separated by colons. Unavailable plugins are skipped.
+// "auto:throughput" compresses a sample of every dataset with several filter
+// chains and uses the best compression ratio reaching `throughput` MB/s (100 by default).
+struct H5_Compression {
+  std::vector<H5Z_filter_t> filters;
+  std::vector<std::vector<unsigned int>> params;
+  bool automatic = false;
+  double min_throughput = 100.0; // MB/s
+};
+
+bool h5_parse_compression(std::string const& spec, H5_Compression& compression);
+
+// set the compression of all datasets written subsequently; deflate at level 9 by default
+void h5_set_compression(H5_Compression const& compression);
+H5_Compression const& h5_get_compression();
+
+// set the target size in bytes of the chunks of datasets written subsequently
+// without given chunk dimensions; 1 MiB by default and at most the 4 GiB limit of HDF5
+void h5_set_chunk_size(size_t size);
+size_t h5_get_chunk_size();
+
+// set the number of threads (de)compressing the chunks of datasets written or
+// read with shuffle and deflate filters; the number of hardware threads by default
+void h5_set_threads(unsigned int threads);
+unsigned int h5_get_threads();
+
+
 // write a buffer to an HDF5 file using compression
 template<typename TYPE>
 bool h5_write_buffer(char const* filename, char const* varname, TYPE const* data, size_t size, std::string const& description="");
@@ -53,6 +221,212 @@ inline bool h5_write_buffer(std::string const& filename, char const* varname, TY
   return h5_write_buffer<TYPE>(filename.c_str(), varname, data, size, description);
 }
 
+// write a buffer with dimensions `dims` (slowest varying dimension first) to an
+// HDF5 file using compression and chunks of dimensions `chunk_dims`;
+// chunks of the target size are used if `chunk_dims` is empty
+template<typename TYPE>
+bool h5_write_buffer(char const* filename, char const* varname, TYPE const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description="");
+
+template<typename TYPE>
+inline bool h5_write_buffer(std::string const& filename, char const* varname, TYPE const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description="")
+{
+  return h5_write_buffer<TYPE>(filename.c_str(), varname, data, dims, chunk_dims, description);
+}
+
+
+// create a dataset of `size` elements without writing any data;
+// all elements read from the dataset are equal to `fill_value`
+template<typename TYPE>
+bool h5_create_buffer(char const* filename, char const* varname, size_t size, TYPE fill_value, std::string const& description="");
+
+template<typename TYPE>
+inline bool h5_create_buffer(std::string const& filename, char const* varname, size_t size, TYPE fill_value, std::string const& description="")
+{
+  return h5_create_buffer<TYPE>(filename.c_str(), varname, size, fill_value, description);
+}
+
+// check whether a dataset is declared only by its shape and a fill value, i.e.
+// it has an attribute `fill_value` or no data has been written to it
+bool h5_check_fill_value(char const* filename, char const* varname);
+// read the fill value of a dataset as a single element of the given type
+bool h5_read_fill_value(char const* filename, char const* varname, HD5_Type type, void* value);
+
+inline bool h5_check_fill_value(std::string const& filename, char const* varname)
+{
+  return h5_check_fill_value(filename.c_str(), varname);
+}
+inline bool h5_read_fill_value(std::string const& filename, char const* varname, HD5_Type type, void* value)
+{
+  return h5_read_fill_value(filename.c_str(), varname, type, value);
+}
+
+
+// dimensions of a dataset, slowest varying dimension first
+bool h5_get_dims(char const* filename, char const* varname, std::vector<size_t>& dims);
+
+inline bool h5_get_dims(std::string const& filename, char const* varname, std::vector<size_t>& dims)
+{
+  return h5_get_dims(filename.c_str(), varname, dims);
+}
+
+// dimensions of the chunks of a dataset; empty if the dataset is not chunked
+bool h5_get_chunk_dims(char const* filename, char const* varname, std::vector<size_t>& chunk_dims);
+
+inline bool h5_get_chunk_dims(std::string const& filename, char const* varname, std::vector<size_t>& chunk_dims)
+{
+  return h5_get_chunk_dims(filename.c_str(), varname, chunk_dims);
+}
+
+// byte offset and size of the data of a dataset if they are stored contiguously,
+// without filters and in native byte order, e.g. for mapping them into memory;
+// false otherwise. `data_filename` is the file containing the data, which differs
+// from `filename` if the dataset is an external link.
+bool h5_get_raw_data_offset(char const* filename, char const* varname, std::string& data_filename, size_t& offset, size_t& size);
+
+inline bool h5_get_raw_data_offset(std::string const& filename, char const* varname, std::string& data_filename, size_t& offset, size_t& size)
+{
+  return h5_get_raw_data_offset(filename.c_str(), varname, data_filename, offset, size);
+}
+
+// Combine `hash` with a hash of an object, i.e. of the attributes and, recursively,
+// the members of a group or the type, shape and stored data of a dataset. False if
+// the object cannot be hashed, e.g. for variable length data.
+bool h5_hash_object(char const* filename, char const* name, uint64_t& hash);
+
+inline bool h5_hash_object(std::string const& filename, char const* name, uint64_t& hash)
+{
+  return h5_hash_object(filename.c_str(), name, hash);
+}
+
+// Region of a buffer which is stored in the output file (a hyperslab of at most
+// three dimensions), declared by the integer attributes `output_offset`,
+// `output_count` and `output_stride` of a dataset. Missing attributes default to
+// an offset of zero, a stride of one, and a count covering the remaining elements.
+struct H5_Selection {
+  std::vector<size_t> dims;
+  std::vector<size_t> offset;
+  std::vector<size_t> stride;
+  std::vector<size_t> count;
+};
+
+// check whether an output selection is declared for a dataset
+bool h5_check_selection(char const* filename, char const* varname);
+bool h5_read_selection(char const* filename, char const* varname, H5_Selection& selection);
+
+inline bool h5_check_selection(std::string const& filename, char const* varname)
+{
+  return h5_check_selection(filename.c_str(), varname);
+}
+inline bool h5_read_selection(std::string const& filename, char const* varname, H5_Selection& selection)
+{
+  return h5_read_selection(filename.c_str(), varname, selection);
+}
+
+// Write the elements `count` with distance `stride` of a dense block `data`
+// with dimensions `mem_dims` as a dataset with dimensions `count`. The chunks
+// are limited to `chunk_dims`, if given.
+bool h5_write_selection(char const* filename, char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& mem_dims, std::vector<size_t> const& stride, std::vector<size_t> const& count,
+  std::vector<size_t> const& chunk_dims, std::string const& description="");
+
+inline bool h5_write_selection(std::string const& filename, char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& mem_dims, std::vector<size_t> const& stride, std::vector<size_t> const& count,
+  std::vector<size_t> const& chunk_dims, std::string const& description="")
+{
+  return h5_write_selection(filename.c_str(), varname, type, data, mem_dims, stride, count, chunk_dims, description);
+}
+
+
+// Layout of the elements of a dataset in device memory. Vectors with three
+// lanes are padded to four lanes and members of compound datasets are aligned
+// as members of structs in OpenCL C, so that kernels can access them as
+// `float3`, `int4`, `struct { ... }` etc. without repacking on the host.
+struct H5_Device_Layout {
+  size_t num_elements;                 // number of scalars, vectors, or structs
+  size_t lanes;                        // lanes of a vector; one for scalars and structs
+  size_t element_size;                 // size in bytes of an element on the device
+  std::vector<unsigned char> mem_type; // encoded HDF5 memory type of array and compound types
+};
+
+// The layout of a dataset on the device. Array types of 2, 3, 4, 8, or 16
+// elements are vectors; datasets of scalars whose last dimension equals
+// `lanes` are vectors if `lanes` > 1 (e.g. given by the kernel signature).
+bool h5_get_device_layout(char const* filename, char const* varname, size_t lanes, H5_Device_Layout& layout);
+
+// whether the device buffer is a plain copy of the dataset
+inline bool h5_is_flat_layout(H5_Device_Layout const& layout)
+{
+  return layout.mem_type.empty() && layout.lanes != 3;
+}
+
+// read a dataset into a buffer of `num_elements * element_size` bytes
+bool h5_read_device_buffer(char const* filename, char const* varname, H5_Device_Layout const& layout, void* data);
+// write a buffer read from the device as dataset with dimensions `dims` (as
+// given by `h5_get_content`) and chunk dimensions `chunk_dims` (may be empty)
+bool h5_write_device_buffer(char const* filename, char const* varname, H5_Device_Layout const& layout, HD5_Type type,
+  void const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims);
+
+inline bool h5_get_device_layout(std::string const& filename, char const* varname, size_t lanes, H5_Device_Layout& layout)
+{
+  return h5_get_device_layout(filename.c_str(), varname, lanes, layout);
+}
+inline bool h5_read_device_buffer(std::string const& filename, char const* varname, H5_Device_Layout const& layout, void* data)
+{
+  return h5_read_device_buffer(filename.c_str(), varname, layout, data);
+}
+inline bool h5_write_device_buffer(std::string const& filename, char const* varname, H5_Device_Layout const& layout, HD5_Type type,
+  void const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims)
+{
+  return h5_write_device_buffer(filename.c_str(), varname, layout, type, data, dims, chunk_dims);
+}
+
+// Files storing the data of a dataset outside of the file are placed next to it
+// and named by the file and the dataset, e.g. "out.data_x" for `/data/x` of
+// "dir/out.h5" with `directory` "dir/" (the suffix is added by the caller)
+void h5_sidecar_name(char const* filename, char const* varname, std::string& directory, std::string& name);
+
+// Write a buffer of scalars with dimensions `dims` as slices along the first
+// dimension of about `shard_size` bytes into separate files, which are compressed
+// on `h5_get_threads()` threads each. The file of the k-th slice
+// of `/data/x` in `out.h5` is `out.data_x.k.h5`, next to `out.h5`, containing the
+// dataset `/data`. The dataset `varname` of `filename` is a virtual dataset
+// mapping the slices, so that it reads as a single dataset.
+bool h5_write_shards(char const* filename, char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, size_t shard_size);
+
+inline bool h5_write_shards(std::string const& filename, char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, size_t shard_size)
+{
+  return h5_write_shards(filename.c_str(), varname, type, data, dims, chunk_dims, shard_size);
+}
+
+
+// Fields of a compound dataset which are uploaded as separate buffers (structure
+// of arrays) and bound to consecutive kernel arguments, declared by the string
+// attribute `soa_fields` of the dataset, e.g. "x,y,z,mass".
+struct H5_Soa_Layout {
+  std::vector<std::string> fields;
+  std::vector<HD5_Type> types;         // scalar types of the fields
+  std::vector<size_t> lanes;           // scalars per record, e.g. 3 for an array member of three elements
+  std::vector<size_t> offsets;         // offsets in bytes of the fields in a packed record
+  size_t record_size;                  // size in bytes of a packed record
+  std::vector<unsigned char> mem_type; // encoded HDF5 memory type of a packed record
+};
+
+bool h5_check_soa_layout(char const* filename, char const* varname);
+bool h5_read_soa_layout(char const* filename, char const* varname, H5_Soa_Layout& layout);
+
+inline bool h5_check_soa_layout(std::string const& filename, char const* varname)
+{
+  return h5_check_soa_layout(filename.c_str(), varname);
+}
+inline bool h5_read_soa_layout(std::string const& filename, char const* varname, H5_Soa_Layout& layout)
+{
+  return h5_read_soa_layout(filename.c_str(), varname, layout);
+}
+
 
 // read a single item from an HDF5 file
 template<typename TYPE>
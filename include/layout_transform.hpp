@@ -0,0 +1,25 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef LAYOUT_TRANSFORM_H
+#define LAYOUT_TRANSFORM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Conversion between an array of structs (packed records of `record_size` bytes)
+// and a structure of arrays (one array per field). The fields are given by their
+// offsets in a record and their sizes in bytes. Records are processed in blocks
+// fitting into the cache, so that every record is loaded from memory only once.
+
+// split `num_records` records of `aos` into the field arrays `soa`
+void aos_to_soa(uint8_t const* aos, size_t num_records, size_t record_size,
+  std::vector<size_t> const& offsets, std::vector<size_t> const& sizes, std::vector<uint8_t*> const& soa);
+
+// interleave the field arrays `soa` into `num_records` records of `aos`
+void soa_to_aos(std::vector<uint8_t const*> const& soa, size_t num_records, size_t record_size,
+  std::vector<size_t> const& offsets, std::vector<size_t> const& sizes, uint8_t* aos);
+
+
+#endif // LAYOUT_TRANSFORM_H
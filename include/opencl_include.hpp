@@ -15,6 +15,8 @@
 #define CL_HPP_ENABLE_EXCEPTIONS
 #define CL_HPP_MINIMUM_OPENCL_VERSION 120
 #define CL_HPP_TARGET_OPENCL_VERSION 120
+// declare the C API of OpenCL 2.0 for shared virtual memory (see svm_memory.hpp)
+#define CL_TARGET_OPENCL_VERSION 200
 #if defined(__APPLE__)
 #define CL_SILENCE_DEPRECATION
 #include <OpenCL/cl2.hpp>
@@ -0,0 +1,102 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef OUTPUT_BACKEND_H
+#define OUTPUT_BACKEND_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hdf5_io.hpp"
+
+
+// Writer of the datasets in `/data` of the output file, used by the store loop.
+// The output file `out_*.h5` itself is always an HDF5 file holding the settings
+// and the housekeeping data; backends differ in where the data are stored.
+class output_backend {
+public:
+  virtual ~output_backend() {}
+
+  // a dataset of scalars of type `type` with dimensions `dims`
+  virtual bool write_buffer(char const* varname, HD5_Type type, void const* data,
+    std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims) = 0;
+  // a dataset of vectors of three lanes or structs (see `h5_write_device_buffer`)
+  virtual bool write_device_buffer(char const* varname, H5_Device_Layout const& layout, HD5_Type type, void const* data,
+    std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims) = 0;
+  // a selection of a dense block (see `h5_write_selection`)
+  virtual bool write_selection(char const* varname, HD5_Type type, void const* data, std::vector<size_t> const& mem_dims,
+    std::vector<size_t> const& stride, std::vector<size_t> const& count, std::vector<size_t> const& chunk_dims) = 0;
+  // a dataset or group unchanged from the input file `input_filename`, copied
+  virtual bool copy_input(char const* varname, char const* input_filename) = 0;
+  // as above, but linked to the input file, which has to be kept (option -link_inputs)
+  virtual bool link_input(char const* varname, char const* input_filename) = 0;
+  // a dataset aliasing the dataset `target_varname` written before
+  virtual bool link_alias(char const* varname, char const* target_varname) = 0;
+};
+
+
+// All datasets are stored in the HDF5 output file; large datasets are split
+// into shard files if `shard_size` is not zero (see `h5_write_shards`).
+class hdf5_output : public output_backend {
+public:
+  hdf5_output(std::string const& filename, size_t shard_size = 0);
+
+  bool write_buffer(char const* varname, HD5_Type type, void const* data,
+    std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims) override;
+  bool write_device_buffer(char const* varname, H5_Device_Layout const& layout, HD5_Type type, void const* data,
+    std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims) override;
+  bool write_selection(char const* varname, HD5_Type type, void const* data, std::vector<size_t> const& mem_dims,
+    std::vector<size_t> const& stride, std::vector<size_t> const& count, std::vector<size_t> const& chunk_dims) override;
+  bool copy_input(char const* varname, char const* input_filename) override;
+  bool link_input(char const* varname, char const* input_filename) override;
+  bool link_alias(char const* varname, char const* target_varname) override;
+
+protected:
+  std::string filename;
+  size_t shard_size;
+};
+
+
+// Datasets of scalars are stored as NumPy `.npy` files next to the output file,
+// e.g. `/data/x` of `out_config.h5` as `out_config.data_x.npy`, written by large
+// aligned writes without compression (bypassing the page cache if `direct_io`
+// is set). The output file refers to them by their names as datasets with external
+// storage, so they can still be read through it wherever the files are, if the
+// reader resolves the names relative to the output file (see `h5_create_external_dataset`).
+// Other datasets are stored as by `hdf5_output`.
+class npy_output : public hdf5_output {
+public:
+  npy_output(std::string const& filename, bool direct_io = false);
+
+  bool write_buffer(char const* varname, HD5_Type type, void const* data,
+    std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims) override;
+
+private:
+  bool direct_io;
+};
+
+
+// Datasets of scalars are stored in POSIX shared memory segments, e.g. `/data/x`
+// of `out_config.h5` in the segment "/out_config.data_x", so that a consumer on
+// the same node can map them without reading a file. A segment has the layout of
+// a .npy file (see `npy_output`). The output file records every segment as a
+// string dataset holding its name, with the string attributes `dtype` (NumPy
+// notation, e.g. "<f4") and `shape`, e.g. "(1000, 3)". Consumers remove segments
+// by `shm_unlink`; with `replace_segments`, the segments of earlier runs with
+// the same output file are removed when the backend is created. Other datasets
+// are stored as by `hdf5_output`.
+class shm_output : public hdf5_output {
+public:
+  shm_output(std::string const& filename, bool replace_segments = true);
+
+  bool write_buffer(char const* varname, HD5_Type type, void const* data,
+    std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims) override;
+};
+
+
+// create the backend given by `format`, i.e. "hdf5", "npy", "npy:direct", "shm"
+// (or "shm:replace"), or "shm:keep"; nullptr if the format is unknown
+std::unique_ptr<output_backend> create_output_backend(std::string const& format, std::string const& filename, size_t shard_size);
+
+
+#endif // OUTPUT_BACKEND_H
@@ -0,0 +1,37 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+
+// Output files of previous runs stored in a directory, keyed by a hash of all
+// inputs of a run, e.g. the kernel source, the settings, the device and the data.
+// Entries and the output files materialized from them are copies (sharing their
+// blocks where the file system supports it), so modifying an output file never
+// changes an entry. Entries are added atomically, so that several runs may share a cache.
+class result_cache {
+public:
+  // use the directory `directory`, which is created if necessary
+  explicit result_cache(std::string const& directory);
+
+  // materialize the output file of `key` as `filename`; false if there is none
+  bool fetch(uint64_t key, std::string const& filename) const;
+  // add the output file `filename` as result of `key`
+  bool store(uint64_t key, std::string const& filename) const;
+
+private:
+  std::string entry_name(uint64_t key) const;
+
+  std::string directory;
+};
+
+
+// hash the kernel source `filename` and the files it includes, found in the
+// working directory or the directories of `-I` options of `build_options`
+uint64_t hash_kernel_source(std::string const& filename, std::string const& build_options, uint64_t hash);
+
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,62 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "hdf5_io.hpp"
+
+
+// Sparse matrices stored as a group of datasets in `/data`, either in CSR format
+// `/data/A/{row_ptr,col_idx,values}` or in COO format `/data/A/{row_idx,col_idx,values}`.
+// The integer attributes `num_rows` and `num_cols` of the group declare the shape;
+// otherwise, it is derived from the indices. COO matrices are converted to CSR
+// on the host. The string attribute `sparse_reorder = "rcm"` renumbers the rows
+// and columns of a square matrix by the reverse Cuthill-McKee algorithm and the
+// string attribute `sparse_format` selects the format on the device, "csr"
+// (default) or "ell".
+struct sparse_matrix {
+  std::string format;              // format on the device
+  HD5_Type value_type;
+  cl_uint num_rows;
+  cl_uint num_cols;
+  std::vector<cl_int> row_ptr;     // num_rows + 1 offsets of the rows in col_idx and values
+  std::vector<cl_int> col_idx;     // sorted per row
+  std::vector<uint8_t> values;     // elements of type value_type
+  std::vector<cl_int> permutation; // old index of every new row and column; empty if not reordered
+};
+
+// The kernel arguments of a sparse matrix in the order they are bound, i.e.
+//   CSR: row_ptr, col_idx, values, [permutation,] num_rows, num_cols
+//   ELL: col_idx, values, [permutation,] num_rows, num_cols, width
+// where the buffers are followed by the dimensions as `uint` scalars. The ELL
+// buffers store the k-th entry of row r at k * num_rows + r and pad short rows
+// with zeros, so that consecutive work items read consecutive elements.
+struct sparse_arguments {
+  std::vector<std::string> names;
+  std::vector<HD5_Type> types;
+  std::vector<size_t> sizes;              // number of elements
+  std::vector<bool> scalars;
+  std::vector<std::vector<uint8_t>> data; // contents of the buffers or values of the scalars
+};
+
+// check whether a group is a sparse matrix, i.e. contains the datasets `col_idx`,
+// `values` and `row_ptr` or `row_idx`
+bool check_sparse_matrix(char const* filename, char const* groupname);
+
+// read a sparse matrix as CSR matrix, reordered if declared by the group
+bool read_sparse_matrix(char const* filename, char const* groupname, sparse_matrix& matrix);
+
+// renumber the rows and columns of a square matrix by the reverse Cuthill-McKee
+// algorithm applied to the pattern of A + A^T, reducing the bandwidth
+bool reorder_rcm(sparse_matrix& matrix);
+
+// get the kernel arguments of a matrix in its device format
+bool get_sparse_arguments(sparse_matrix const& matrix, sparse_arguments& arguments);
+
+
+#endif // SPARSE_MATRIX_H
@@ -0,0 +1,58 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef STAGING_ARENA_H
+#define STAGING_ARENA_H
+
+#include <cstdint>
+#include <vector>
+
+#include "opencl_include.hpp"
+
+
+// Host memory used for the transfers between the HDF5 files and the device.
+// Blocks are page aligned and reused after they have been released; free blocks
+// too small for a request are returned before a larger one is allocated. By default,
+// they are allocated by the OpenCL runtime (CL_MEM_ALLOC_HOST_PTR) and mapped,
+// so that the runtime can use them for DMA transfers. If `huge_pages` is set,
+// they are allocated using huge pages (if available) and wrapped with
+// CL_MEM_USE_HOST_PTR instead.
+class staging_arena {
+public:
+  staging_arena(cl::Context& context, cl::CommandQueue& queue, bool huge_pages = false);
+  ~staging_arena();
+
+  staging_arena(staging_arena const&) = delete;
+  staging_arena& operator=(staging_arena const&) = delete;
+
+  // get a block of at least `size` bytes; nullptr if it cannot be allocated
+  uint8_t* acquire(size_t size);
+  // return a block obtained by `acquire` for later reuse
+  void release(uint8_t* ptr);
+
+  // maximal number of bytes of the blocks in use at the same time
+  size_t high_water_mark() const { return max_size; }
+
+private:
+  struct block {
+    cl::Buffer buffer;
+    uint8_t* ptr;
+    size_t size;
+    bool in_use;
+    bool host_alloc; // allocated by the arena instead of the OpenCL runtime
+  };
+
+  size_t round_up(size_t size) const;
+  void free_block(block& blk);
+
+  cl::Context context;
+  cl::CommandQueue queue;
+  bool huge_pages;
+  size_t page_size;
+
+  std::vector<block> blocks;
+  size_t used_size;
+  size_t max_size;
+};
+
+
+#endif // STAGING_ARENA_H
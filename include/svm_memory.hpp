@@ -0,0 +1,45 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef SVM_MEMORY_H
+#define SVM_MEMORY_H
+
+#include <vector>
+
+#include "opencl_include.hpp"
+
+
+// Shared virtual memory (OpenCL 2.0) for the buffers of the datasets. The data
+// are read from and written to the HDF5 files directly in the shared memory,
+// and kernels get the SVM pointers as arguments, so that pointers stored by a
+// kernel remain valid in subsequent kernels. Every allocation is wrapped in a
+// buffer (CL_MEM_USE_HOST_PTR) for transfers using the buffer API.
+class svm_memory {
+public:
+  // check whether `device` supports at least coarse-grained SVM buffers
+  static bool is_supported(cl::Device const& device);
+
+  svm_memory(cl::Context& context, cl::CommandQueue& queue, cl::Device const& device);
+  ~svm_memory();
+
+  svm_memory(svm_memory const&) = delete;
+  svm_memory& operator=(svm_memory const&) = delete;
+
+  // allocate `size` bytes and create a buffer using them
+  void* allocate(size_t size, cl_mem_flags flags, cl::Buffer& buffer);
+
+  // host access to coarse-grained allocations; nothing to do for fine-grained ones
+  void map(void* ptr, size_t size, cl_map_flags flags);
+  void unmap(void* ptr);
+
+  void set_arg(cl::Kernel& kernel, cl_uint arg_idx, void* ptr);
+
+private:
+  cl::Context context;
+  cl::CommandQueue queue;
+  bool fine_grain;
+
+  std::vector<void*> allocations;
+};
+
+
+#endif // SVM_MEMORY_H
@@ -0,0 +1,31 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#ifndef TYPE_CONVERSION_H
+#define TYPE_CONVERSION_H
+
+#include <string>
+
+#include "hdf5_io.hpp"
+
+
+// Conversion of buffers between the type of a dataset in the HDF5 file and the
+// type used on the device, declared by the string attribute `device_type` of a
+// dataset, e.g. "float" for a dataset of doubles. Conversions between floating
+// point types round to nearest; conversions to integer types saturate and
+// truncate floating point values towards zero, as the type conversions of HDF5.
+
+// get the type of the OpenCL C type name `name`, e.g. "float" or "uint"
+bool parse_type_name(std::string const& name, HD5_Type& type);
+
+// check whether a dataset declares a device type, i.e. has an attribute `device_type`
+bool check_device_type(char const* filename, char const* varname);
+
+// read the device type of a dataset
+bool read_device_type(char const* filename, char const* varname, HD5_Type& type);
+
+// convert `num_elements` scalars of type `src_type` in `src` to `dst_type` in `dst`;
+// the buffers must not overlap
+bool convert_buffer(void const* src, HD5_Type src_type, void* dst, HD5_Type dst_type, size_t num_elements);
+
+
+#endif // TYPE_CONVERSION_H
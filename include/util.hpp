@@ -3,6 +3,10 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <cstdint>
+#include <cstring>
+#include <string>
+
 #if defined(_WIN32)
 #include <io.h>
 #define access _access_s
@@ -26,4 +30,55 @@ inline bool fileExists(std::string const& filename)
 }
 
 
+// hashing
+
+inline uint64_t rotate_left(uint64_t value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// Fast non-cryptographic 64 bit hash of a byte sequence, e.g. to detect changed
+// inputs. Four independent lanes consume 32 bytes per step.
+inline uint64_t hash_bytes(void const* data, size_t size, uint64_t seed = 0)
+{
+  constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+  constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+  constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+  uint8_t const* bytes = static_cast<uint8_t const*>(data);
+
+  uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+  size_t pos = 0;
+  for (; pos + 32 <= size; pos += 32) {
+    for (int lane = 0; lane < 4; lane++) {
+      uint64_t word;
+      std::memcpy(&word, bytes + pos + 8 * lane, 8);
+      lanes[lane] = rotate_left(lanes[lane] + word * prime2, 31) * prime1;
+    }
+  }
+
+  uint64_t hash = rotate_left(lanes[0], 1) + rotate_left(lanes[1], 7) + rotate_left(lanes[2], 12)
+                + rotate_left(lanes[3], 18) + size;
+  for (; pos < size; pos++) {
+    hash = rotate_left(hash ^ (bytes[pos] * prime3), 11) * prime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= prime2;
+  hash ^= hash >> 29;
+  hash *= prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+inline uint64_t hash_combine(uint64_t hash, uint64_t value)
+{
+  return hash_bytes(&value, sizeof(value), hash);
+}
+
+inline uint64_t hash_combine(uint64_t hash, std::string const& text)
+{
+  return hash_bytes(text.data(), text.size(), hash_combine(hash, (uint64_t)text.size()));
+}
+
+
 #endif // UTIL_H
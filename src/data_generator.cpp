@@ -0,0 +1,264 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+#include "ocl_dev_mgr.hpp"
+#include "data_generator.hpp"
+
+
+using namespace std;
+
+
+// OpenCL kernels generating data. Random numbers are computed using the
+// counter-based generator Philox4x32-10 of Salmon et al. (2011), "Parallel
+// random numbers: as easy as 1, 2, 3". The counter is the index of an element
+// and the key is the seed, so that the values do not depend on the device or
+// the work group size.
+static char const* generator_source = R"CLC(
+#ifdef USE_DOUBLE
+  #pragma OPENCL EXTENSION cl_khr_fp64 : enable
+  typedef double real;
+#else
+  typedef float real;
+#endif
+
+#ifdef INTEGER
+  typedef long param;
+  #define CONCAT_(a, b) a##b
+  #define CONCAT(a, b) CONCAT_(a, b)
+  #define CONVERT(x) CONCAT(convert_, CONCAT(VALUE_TYPE, _sat_rte))(x)
+#else
+  typedef real param;
+  #define CONVERT(x) ((VALUE_TYPE)(x))
+#endif
+
+uint4 philox4x32_10(ulong idx, ulong seed)
+{
+  uint4 ctr = (uint4)((uint)idx, (uint)(idx >> 32), 0u, 0u);
+  uint2 key = (uint2)((uint)seed, (uint)(seed >> 32));
+
+  for (int round = 0; round < 10; ++round) {
+    const uint hi0 = mul_hi(0xD2511F53u, ctr.x);
+    const uint lo0 = 0xD2511F53u * ctr.x;
+    const uint hi1 = mul_hi(0xCD9E8D57u, ctr.z);
+    const uint lo1 = 0xCD9E8D57u * ctr.z;
+    ctr = (uint4)(hi1 ^ ctr.y ^ key.x, lo1, hi0 ^ ctr.w ^ key.y, lo0);
+    key += (uint2)(0x9E3779B9u, 0xBB67AE85u);
+  }
+
+  return ctr;
+}
+
+// uniformly distributed in [0, 1)
+real uniform01(uint a, uint b)
+{
+#ifdef USE_DOUBLE
+  return (((ulong)a << 21) | (b >> 11)) * 0x1.0p-53;
+#else
+  return (a >> 8) * 0x1.0p-24f;
+#endif
+}
+
+kernel void generate_uniform(global VALUE_TYPE* out, ulong n, ulong seed, param a, param b)
+{
+  const ulong gid = get_global_id(0);
+  if (gid >= n) {
+    return;
+  }
+
+  const uint4 r = philox4x32_10(gid, seed);
+#ifdef INTEGER
+  // integers in [a, b]
+  const ulong range = (ulong)(b - a) + 1;
+  const ulong bits = ((ulong)r.x << 32) | r.y;
+  out[gid] = (VALUE_TYPE)(a + (long)(range == 0 ? bits : bits % range));
+#else
+  // real numbers in [a, b)
+  out[gid] = a + (b - a) * uniform01(r.x, r.y);
+#endif
+}
+
+kernel void generate_normal(global VALUE_TYPE* out, ulong n, ulong seed, real mean, real stddev)
+{
+  const ulong gid = get_global_id(0);
+  if (gid >= n) {
+    return;
+  }
+
+  // Box-Muller transform; u1 in (0, 1] avoids log(0)
+  const uint4 r = philox4x32_10(gid, seed);
+  const real u1 = 1 - uniform01(r.x, r.y);
+  const real u2 = uniform01(r.z, r.w);
+  out[gid] = CONVERT(mean + stddev * sqrt(-2 * log(u1)) * cospi(2 * u2));
+}
+
+kernel void generate_iota(global VALUE_TYPE* out, ulong n, param start)
+{
+  const ulong gid = get_global_id(0);
+  if (gid >= n) {
+    return;
+  }
+
+  out[gid] = (VALUE_TYPE)(start + (param)gid);
+}
+
+kernel void generate_linear(global VALUE_TYPE* out, ulong n, real start, real stop)
+{
+  const ulong gid = get_global_id(0);
+  if (gid >= n) {
+    return;
+  }
+
+  const real step = (n > 1) ? (stop - start) / (real)(n - 1) : 0;
+  out[gid] = CONVERT(start + step * (real)gid);
+}
+)CLC";
+
+
+static char const* opencl_type_name(HD5_Type type)
+{
+  switch (type) {
+    case H5_float:  return "float";
+    case H5_double: return "double";
+    case H5_char:   return "char";
+    case H5_uchar:  return "uchar";
+    case H5_short:  return "short";
+    case H5_ushort: return "ushort";
+    case H5_int:    return "int";
+    case H5_uint:   return "uint";
+    case H5_long:   return "long";
+    case H5_ulong:  return "ulong";
+    case H5_half:   return "half";
+    case H5_compound: break;
+  }
+
+  return "";
+}
+
+
+bool check_generator(char const* filename, char const* varname)
+{
+  return h5_check_attribute(filename, varname, "generator");
+}
+
+
+bool read_generator(char const* filename, char const* varname, data_generator& generator)
+{
+  if (!h5_read_attribute_string(filename, varname, "generator", generator.distribution)) {
+    return false;
+  }
+
+  // optional parameters and their default values
+  char const* name1;
+  char const* name2;
+  generator.seed = 0;
+  generator.param1 = 0;
+  generator.param2 = 1;
+
+  if (generator.distribution == "uniform") {
+    name1 = "min"; name2 = "max";
+  }
+  else if (generator.distribution == "normal") {
+    name1 = "mean"; name2 = "stddev";
+  }
+  else if (generator.distribution == "iota") {
+    name1 = "start"; name2 = nullptr;
+  }
+  else if (generator.distribution == "linear") {
+    name1 = "start"; name2 = "stop";
+  }
+  else {
+    std::cerr << ERROR_INFO << "Unknown generator '" << generator.distribution << "' of '" << varname << "'." << std::endl;
+    return false;
+  }
+
+  if (h5_check_attribute(filename, varname, "seed")) {
+    h5_read_attribute<cl_ulong>(filename, varname, "seed", generator.seed);
+  }
+  if (h5_check_attribute(filename, varname, name1)) {
+    h5_read_attribute<double>(filename, varname, name1, generator.param1);
+  }
+  if (name2 != nullptr && h5_check_attribute(filename, varname, name2)) {
+    h5_read_attribute<double>(filename, varname, name2, generator.param2);
+  }
+
+  return true;
+}
+
+
+bool run_generator(ocl_dev_mgr& dev_mgr, data_generator const& generator, HD5_Type type, cl::Buffer& buffer, size_t size)
+{
+  if (size == 0) {
+    return true;
+  }
+
+  // arithmetics on half precision values require the extension cl_khr_fp16
+  if (type == H5_half || type == H5_compound) {
+    std::cerr << ERROR_INFO << "Generators for data type '" << opencl_type_name(type) << "' are not supported." << std::endl;
+    return false;
+  }
+
+  // the generator program is compiled once for every data type
+  static vector<string> compiled_programs;
+
+  string prog_name = string("toolkitICL_generator_") + opencl_type_name(type);
+  if (find(compiled_programs.begin(), compiled_programs.end(), prog_name) == compiled_programs.end()) {
+    string options = string("-DVALUE_TYPE=") + opencl_type_name(type);
+    if (type == H5_double) {
+      options += " -DUSE_DOUBLE";
+    }
+    else if (type != H5_float) {
+      options += " -DINTEGER";
+    }
+
+    dev_mgr.add_program_str(0, prog_name, generator_source);
+    if (dev_mgr.compile_kernel(0, prog_name, options) == 0) {
+      std::cerr << ERROR_INFO << "Compiling the data generators for type '" << opencl_type_name(type) << "' failed." << std::endl;
+      return false;
+    }
+    compiled_programs.push_back(prog_name);
+  }
+
+  cl::Kernel* kernel = dev_mgr.getKernelbyName(0, prog_name, "generate_" + generator.distribution);
+
+  // parameters are passed using the precision of the buffer; integer types use
+  // integer parameters for `uniform` and `iota`
+  bool integer_param = (type != H5_float) && (type != H5_double)
+                    && (generator.distribution == "uniform" || generator.distribution == "iota");
+  auto set_param = [&](cl_uint arg_idx, double value, bool allow_integer) {
+    if (allow_integer && integer_param) {
+      kernel->setArg(arg_idx, (cl_long)value);
+    }
+    else if (type == H5_double) {
+      kernel->setArg(arg_idx, (cl_double)value);
+    }
+    else {
+      kernel->setArg(arg_idx, (cl_float)value);
+    }
+  };
+
+  kernel->setArg(0, buffer);
+  kernel->setArg(1, (cl_ulong)size);
+  if (generator.distribution == "uniform" || generator.distribution == "normal") {
+    kernel->setArg(2, generator.seed);
+    set_param(3, generator.param1, true);
+    set_param(4, generator.param2, true);
+  }
+  else if (generator.distribution == "iota") {
+    set_param(2, generator.param1, true);
+  }
+  else {
+    set_param(2, generator.param1, false);
+    set_param(3, generator.param2, false);
+  }
+
+  dev_mgr.get_queue(0, 0).enqueueNDRangeKernel(*kernel, cl::NullRange, cl::NDRange(size), cl::NullRange);
+
+  return true;
+}
@@ -0,0 +1,177 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+#include "data_image.hpp"
+
+
+using namespace std;
+
+
+// channel orders and the corresponding number of channels
+static bool parse_channel_order(string const& name, cl_channel_order& order, size_t& channels)
+{
+  if      (name == "R")         { order = CL_R;         channels = 1; }
+  else if (name == "A")         { order = CL_A;         channels = 1; }
+  else if (name == "INTENSITY") { order = CL_INTENSITY; channels = 1; }
+  else if (name == "LUMINANCE") { order = CL_LUMINANCE; channels = 1; }
+  else if (name == "RG")        { order = CL_RG;        channels = 2; }
+  else if (name == "RA")        { order = CL_RA;        channels = 2; }
+  else if (name == "RGBA")      { order = CL_RGBA;      channels = 4; }
+  else if (name == "BGRA")      { order = CL_BGRA;      channels = 4; }
+  else if (name == "ARGB")      { order = CL_ARGB;      channels = 4; }
+  else {
+    return false;
+  }
+
+  return true;
+}
+
+// channel types and the size in bytes of a channel
+static bool parse_channel_type(string const& name, cl_channel_type& channel_type, size_t& size)
+{
+  if      (name == "snorm_int8")     { channel_type = CL_SNORM_INT8;     size = 1; }
+  else if (name == "snorm_int16")    { channel_type = CL_SNORM_INT16;    size = 2; }
+  else if (name == "unorm_int8")     { channel_type = CL_UNORM_INT8;     size = 1; }
+  else if (name == "unorm_int16")    { channel_type = CL_UNORM_INT16;    size = 2; }
+  else if (name == "signed_int8")    { channel_type = CL_SIGNED_INT8;    size = 1; }
+  else if (name == "signed_int16")   { channel_type = CL_SIGNED_INT16;   size = 2; }
+  else if (name == "signed_int32")   { channel_type = CL_SIGNED_INT32;   size = 4; }
+  else if (name == "unsigned_int8")  { channel_type = CL_UNSIGNED_INT8;  size = 1; }
+  else if (name == "unsigned_int16") { channel_type = CL_UNSIGNED_INT16; size = 2; }
+  else if (name == "unsigned_int32") { channel_type = CL_UNSIGNED_INT32; size = 4; }
+  else if (name == "half_float")     { channel_type = CL_HALF_FLOAT;     size = 2; }
+  else if (name == "float")          { channel_type = CL_FLOAT;          size = 4; }
+  else {
+    return false;
+  }
+
+  return true;
+}
+
+// channel type used if no attribute `image_channel_type` is given
+static bool default_channel_type(HD5_Type type, cl_channel_type& channel_type)
+{
+  switch (type) {
+    case H5_float:  channel_type = CL_FLOAT;          return true;
+    case H5_half:   channel_type = CL_HALF_FLOAT;     return true;
+    case H5_char:   channel_type = CL_SIGNED_INT8;    return true;
+    case H5_uchar:  channel_type = CL_UNSIGNED_INT8;  return true;
+    case H5_short:  channel_type = CL_SIGNED_INT16;   return true;
+    case H5_ushort: channel_type = CL_UNSIGNED_INT16; return true;
+    case H5_int:    channel_type = CL_SIGNED_INT32;   return true;
+    case H5_uint:   channel_type = CL_UNSIGNED_INT32; return true;
+    case H5_double:
+    case H5_long:
+    case H5_ulong:
+    case H5_compound: break;
+  }
+
+  return false;
+}
+
+
+bool check_image(char const* filename, char const* varname)
+{
+  return h5_check_attribute(filename, varname, "image_channel_order");
+}
+
+
+bool read_image(char const* filename, char const* varname, HD5_Type type, std::vector<size_t> const& dims, data_image& image)
+{
+  string order_name;
+  if (!h5_read_attribute_string(filename, varname, "image_channel_order", order_name)) {
+    return false;
+  }
+
+  cl_channel_order channel_order;
+  if (!parse_channel_order(order_name, channel_order, image.channels)) {
+    cerr << ERROR_INFO << "Unknown image channel order '" << order_name << "' of '" << varname << "'." << endl;
+    return false;
+  }
+
+  cl_channel_type channel_type;
+  if (h5_check_attribute(filename, varname, "image_channel_type")) {
+    string type_name;
+    size_t channel_size = 0;
+    h5_read_attribute_string(filename, varname, "image_channel_type", type_name);
+    if (!parse_channel_type(type_name, channel_type, channel_size)) {
+      cerr << ERROR_INFO << "Unknown image channel type '" << type_name << "' of '" << varname << "'." << endl;
+      return false;
+    }
+    if (channel_size != get_type_size(type)) {
+      cerr << ERROR_INFO << "Image channel type '" << type_name << "' does not match the data type of '" << varname << "'." << endl;
+      return false;
+    }
+  }
+  else if (!default_channel_type(type, channel_type)) {
+    cerr << ERROR_INFO << "Data type '" << type << "' of '" << varname << "' cannot be used for images." << endl;
+    return false;
+  }
+
+  image.format = cl::ImageFormat(channel_order, channel_type);
+
+  // the channels are the fastest varying dimension
+  vector<size_t> image_dims(dims);
+  if (image.channels > 1) {
+    if (image_dims.empty() || image_dims.back() != image.channels) {
+      cerr << ERROR_INFO << "The last dimension of '" << varname << "' does not match its " << image.channels << " image channels." << endl;
+      return false;
+    }
+    image_dims.pop_back();
+  }
+
+  if (image_dims.size() == 2) {
+    image.depth = 1;
+    image.height = image_dims.at(0);
+    image.width = image_dims.at(1);
+  }
+  else if (image_dims.size() == 3) {
+    image.depth = image_dims.at(0);
+    image.height = image_dims.at(1);
+    image.width = image_dims.at(2);
+  }
+  else {
+    cerr << ERROR_INFO << "Images like '" << varname << "' must have two or three dimensions." << endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+cl::Memory create_image(cl::Context& context, cl::CommandQueue& queue, cl_mem_flags flags, data_image const& image, void const* data)
+{
+  cl::array<cl::size_type, 3> origin = {{0, 0, 0}};
+  cl::array<cl::size_type, 3> region = {{image.width, image.height, image.depth}};
+
+  if (image.depth == 1) {
+    cl::Image2D image_object(context, flags, image.format, image.width, image.height);
+    if (data != nullptr) {
+      queue.enqueueWriteImage(image_object, CL_TRUE, origin, region, 0, 0, data);
+    }
+    return image_object;
+  }
+  else {
+    cl::Image3D image_object(context, flags, image.format, image.width, image.height, image.depth);
+    if (data != nullptr) {
+      queue.enqueueWriteImage(image_object, CL_TRUE, origin, region, 0, 0, data);
+    }
+    return image_object;
+  }
+}
+
+
+void read_image_data(cl::CommandQueue& queue, cl::Memory const& memory, data_image const& image, void* data)
+{
+  cl::array<cl::size_type, 3> origin = {{0, 0, 0}};
+  cl::array<cl::size_type, 3> region = {{image.width, image.height, image.depth}};
+
+  cl::Image image_object(memory(), true);
+  queue.enqueueReadImage(image_object, CL_TRUE, origin, region, 0, 0, data);
+}
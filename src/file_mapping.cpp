@@ -0,0 +1,89 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "file_mapping.hpp"
+
+
+file_mapper::~file_mapper()
+{
+  for (region& reg : regions) {
+    unmap_region(reg);
+  }
+}
+
+uint8_t* file_mapper::map(char const* filename, size_t offset, size_t size)
+{
+  if (size == 0) {
+    return nullptr;
+  }
+
+  // mappings start at a multiple of the granularity
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  size_t granularity = info.dwAllocationGranularity;
+#else
+  size_t granularity = sysconf(_SC_PAGESIZE);
+#endif
+  size_t start = offset - offset % granularity;
+  size_t length = size + (offset - start);
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  CloseHandle(file);
+  if (mapping == NULL) {
+    return nullptr;
+  }
+  void* base = MapViewOfFile(mapping, FILE_MAP_COPY, (DWORD)((uint64_t)start >> 32), (DWORD)(start & 0xFFFFFFFF), length);
+  CloseHandle(mapping);
+  if (base == NULL) {
+    return nullptr;
+  }
+#else
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  void* base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)start);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+  // the data are read once from the beginning to the end
+  madvise(base, length, MADV_SEQUENTIAL);
+#endif
+
+  regions.push_back(region{(uint8_t*)base + (offset - start), base, length});
+  return regions.back().ptr;
+}
+
+void file_mapper::unmap(uint8_t* ptr)
+{
+  for (size_t idx = 0; idx < regions.size(); ++idx) {
+    if (regions.at(idx).ptr == ptr) {
+      unmap_region(regions.at(idx));
+      regions.erase(regions.begin() + idx);
+      return;
+    }
+  }
+}
+
+void file_mapper::unmap_region(region& reg)
+{
+#if defined(_WIN32)
+  UnmapViewOfFile(reg.base);
+#else
+  munmap(reg.base, reg.length);
+#endif
+}
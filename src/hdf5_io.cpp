@@ -2,21 +2,30 @@
 
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <numeric>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "hdf5.h"
 #include "hdf5_hl.h"
+#include "zlib.h"
 
 #include "opencl_include.hpp"
 
 #include "util.hpp"
+#include "timer.hpp"
 #include "hdf5_io.hpp"
 
-#define chunk_factor 64
-
 using namespace std;
 
 
@@ -24,6 +33,118 @@ using namespace std;
 // TODO: Add HDF append functions
 
 
+// files kept open by sessions, by their absolute path
+static std::map<std::string, h5_file_session const*> open_sessions;
+
+std::string h5_absolute_path(char const* filename)
+{
+#if defined(_WIN32)
+  char* path = _fullpath(NULL, filename, 0);
+#else
+  char* path = realpath(filename, NULL);
+#endif
+  if (path == nullptr) {
+    return filename;
+  }
+  std::string key(path);
+  free(path);
+  return key;
+}
+
+// all spellings of a file name refer to the same session
+static std::string session_key(char const* filename)
+{
+  return h5_absolute_path(filename);
+}
+
+static std::map<std::string, h5_file_session const*>::iterator find_session(char const* filename)
+{
+  if (open_sessions.empty()) {
+    return open_sessions.end();
+  }
+  return open_sessions.find(session_key(filename));
+}
+
+h5_file_session::h5_file_session(std::string const& filename, bool writable)
+  : name(filename), writable(writable)
+{
+  if (writable && !fileExists(filename)) {
+    file_id = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  }
+  else {
+    file_id = H5Fopen(filename.c_str(), writable ? H5F_ACC_RDWR : H5F_ACC_RDONLY, H5P_DEFAULT);
+  }
+
+  if (file_id < 0) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' could not be opened." << std::endl;
+    return;
+  }
+  std::string const key = session_key(filename.c_str());
+  if (open_sessions.count(key) == 0) {
+    open_sessions[key] = this;
+  }
+}
+
+h5_file_session::~h5_file_session()
+{
+  for (auto session = open_sessions.begin(); session != open_sessions.end(); ++session) {
+    if (session->second == this) {
+      open_sessions.erase(session);
+      break;
+    }
+  }
+  if (file_id >= 0) {
+    H5Fclose(file_id);
+  }
+}
+
+bool h5_file_session::flush() const
+{
+  return file_id >= 0 && H5Fflush(file_id, H5F_SCOPE_LOCAL) >= 0;
+}
+
+
+// Open a file with the given access, using the file of a session if possible.
+// Files opened by this function are closed by `h5_close_file`.
+static hid_t h5_open_file(char const* filename, unsigned access)
+{
+  auto session = find_session(filename);
+  if (session != open_sessions.end()) {
+    if (access == H5F_ACC_RDONLY || session->second->is_writable()) {
+      return session->second->id();
+    }
+    std::cerr << ERROR_INFO << "File '" << filename << "' is opened read only." << std::endl;
+  }
+  return H5Fopen(filename, access, H5P_DEFAULT);
+}
+
+// create a new file or, if a writable session of the file exists, use its file
+static hid_t h5_create_file(char const* filename)
+{
+  auto session = find_session(filename);
+  if (session != open_sessions.end() && session->second->is_writable()) {
+    return session->second->id();
+  }
+  return H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+}
+
+bool h5_has_session(char const* filename)
+{
+  return find_session(filename) != open_sessions.end();
+}
+
+// close a file unless it belongs to a session
+static herr_t h5_close_file(hid_t file_id)
+{
+  for (auto const& session : open_sessions) {
+    if (session.second->id() == file_id) {
+      return 0;
+    }
+  }
+  return H5Fclose(file_id);
+}
+
+
 // convert a C type TYPE to the HDF5 identifier of that type
 template<>
 hid_t type_to_h5_type<float>() { return H5T_NATIVE_FLOAT; }
@@ -91,19 +212,88 @@ template<typename TYPE>
 constexpr size_t get_vector_size() { return 1; };
 
 
+// IEEE 754 half precision in host byte order; HDF5 has no predefined type
+static hid_t h5_half_type()
+{
+  static hid_t half_type = H5I_INVALID_HID;
+  if (half_type == H5I_INVALID_HID) {
+    half_type = H5Tcopy(H5T_NATIVE_FLOAT);
+    H5Tset_fields(half_type, 15, 10, 5, 0, 10);
+    H5Tset_size(half_type, 2);
+    H5Tset_ebias(half_type, 15);
+    H5Tlock(half_type);
+  }
+  return half_type;
+}
+
+// memory type of an integer or floating point type; 16 bit floating point types
+// are read as half precision instead of the native float type
+static hid_t h5_native_type(hid_t datatype)
+{
+  if (H5Tget_class(datatype) == H5T_FLOAT && H5Tget_size(datatype) == 2) {
+    return H5Tcopy(h5_half_type());
+  }
+  return H5Tget_native_type(datatype, H5T_DIR_ASCEND);
+}
+
+
+hid_t type_to_h5_type(HD5_Type type)
+{
+  switch (type) {
+    case H5_float:  return type_to_h5_type<cl_float>();
+    case H5_double: return type_to_h5_type<cl_double>();
+    case H5_char:   return type_to_h5_type<cl_char>();
+    case H5_uchar:  return type_to_h5_type<cl_uchar>();
+    case H5_short:  return type_to_h5_type<cl_short>();
+    case H5_ushort: return type_to_h5_type<cl_ushort>();
+    case H5_int:    return type_to_h5_type<cl_int>();
+    case H5_uint:   return type_to_h5_type<cl_uint>();
+    case H5_long:   return type_to_h5_type<cl_long>();
+    case H5_ulong:  return type_to_h5_type<cl_ulong>();
+    case H5_half:   return h5_half_type();
+    case H5_compound: break;
+  }
+
+  std::cerr << ERROR_INFO << "Data type '" << type << "' unknown." << std::endl;
+  return H5I_INVALID_HID;
+}
+
+
+size_t get_type_size(HD5_Type type)
+{
+  switch (type) {
+    case H5_float:  return sizeof(cl_float);
+    case H5_double: return sizeof(cl_double);
+    case H5_char:   return sizeof(cl_char);
+    case H5_uchar:  return sizeof(cl_uchar);
+    case H5_short:  return sizeof(cl_short);
+    case H5_ushort: return sizeof(cl_ushort);
+    case H5_int:    return sizeof(cl_int);
+    case H5_uint:   return sizeof(cl_uint);
+    case H5_long:   return sizeof(cl_long);
+    case H5_ulong:  return sizeof(cl_ulong);
+    case H5_half:   return sizeof(cl_half);
+    case H5_compound: break;
+  }
+
+  std::cerr << ERROR_INFO << "Data type '" << type << "' unknown." << std::endl;
+  return 0;
+}
+
+
 bool h5_check_object(char const* filename, char const* varname)
 {
   hid_t h5_file_id;
 
   if (fileExists(filename)) {
-    h5_file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
 
     if (H5LTpath_valid(h5_file_id, varname, true) > 0) {
-      H5Fclose(h5_file_id);
+      h5_close_file(h5_file_id);
       return true;
     }
     else {
-      H5Fclose(h5_file_id);
+      h5_close_file(h5_file_id);
       return false;
     }
   }
@@ -113,15 +303,100 @@ bool h5_check_object(char const* filename, char const* varname)
 }
 
 
+// Get the type and the identity (file number and address or token) of an
+// object, following soft and external links. Returns false for dangling links.
+static bool h5_get_object_info(hid_t loc_id, char const* name, H5O_type_t& type, std::string& identity)
+{
+  herr_t err;
+  std::ostringstream id;
+
+  H5E_BEGIN_TRY {
+#if H5_VERSION_GE(1,12,0)
+    H5O_info2_t info;
+    err = H5Oget_info_by_name3(loc_id, name, &info, H5O_INFO_BASIC, H5P_DEFAULT);
+    if (err >= 0) {
+      char* token = nullptr;
+      H5Otoken_to_str(loc_id, &info.token, &token);
+      id << info.fileno << ":" << token;
+      H5free_memory(token);
+    }
+#elif H5_VERSION_GE(1,10,3)
+    H5O_info_t info;
+    err = H5Oget_info_by_name2(loc_id, name, &info, H5O_INFO_BASIC, H5P_DEFAULT);
+    id << info.fileno << ":" << info.addr;
+#else
+    H5O_info_t info;
+    err = H5Oget_info_by_name(loc_id, name, &info, H5P_DEFAULT);
+    id << info.fileno << ":" << info.addr;
+#endif
+    type = info.type;
+  } H5E_END_TRY;
+
+  identity = id.str();
+  return err >= 0;
+}
+
+
+// get the HD5_Type corresponding to an HDF5 type, if any
+static bool h5_get_type(hid_t datatype, HD5_Type& type)
+{
+  if (H5Tequal(datatype, type_to_h5_type<float>()) > 0) {
+    type = H5_float;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<double>()) > 0) {
+    type = H5_double;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<cl_char>()) > 0) {
+    type = H5_char;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<cl_uchar>()) > 0) {
+    type = H5_uchar;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<cl_short>()) > 0) {
+    type = H5_short;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<cl_ushort>()) > 0) {
+    type = H5_ushort;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<cl_int>()) > 0) {
+    type = H5_int;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<cl_uint>()) > 0) {
+    type = H5_uint;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<cl_long>()) > 0) {
+    type = H5_long;
+  }
+  else if (H5Tequal(datatype, type_to_h5_type<cl_ulong>()) > 0) {
+    type = H5_ulong;
+  }
+  else if (H5Tget_class(datatype) == H5T_FLOAT && H5Tget_size(datatype) == 2) {
+    type = H5_half;
+  }
+  else {
+    return false;
+  }
+  return true;
+}
+
+
 bool h5_get_content(char const* filename, char const* hdf_dir,
   std::vector<std::string>& data_names, std::vector<HD5_Type>& data_types, std::vector<size_t>& data_sizes)
+{
+  std::vector<std::vector<size_t>> data_dims;
+  return h5_get_content(filename, hdf_dir, data_names, data_types, data_sizes, data_dims);
+}
+
+bool h5_get_content(char const* filename, char const* hdf_dir,
+  std::vector<std::string>& data_names, std::vector<HD5_Type>& data_types, std::vector<size_t>& data_sizes,
+  std::vector<std::vector<size_t>>& data_dims)
 {
   if (!fileExists(filename)) {
     std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
     return false;
   }
 
-  hid_t h5_file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
   hid_t grp = H5Gopen(h5_file_id, hdf_dir, H5P_DEFAULT);
 
   hsize_t nobj;
@@ -129,8 +404,9 @@ bool h5_get_content(char const* filename, char const* hdf_dir,
 
   for (hsize_t obj_idx = 0; obj_idx < nobj; obj_idx++) {
 
+    // soft and external links to datasets are resolved
     int object_type = H5Gget_objtype_by_idx(grp, obj_idx);
-    if (object_type != H5G_DATASET) {
+    if (object_type != H5G_DATASET && object_type != H5G_LINK && object_type != H5G_UDLINK) {
       continue;
     }
 
@@ -138,47 +414,44 @@ bool h5_get_content(char const* filename, char const* hdf_dir,
     vector<char> object_name(len + 1, '\0');
     H5Gget_objname_by_idx(grp, obj_idx, &(object_name[0]), len + 1);
 
-    data_names.push_back(string(hdf_dir) + string(object_name.begin(), object_name.end()));
+    H5O_type_t target_type;
+    std::string identity;
+    if (!h5_get_object_info(grp, &(object_name[0]), target_type, identity) || target_type != H5O_TYPE_DATASET) {
+      continue;
+    }
+
+    data_names.push_back(string(hdf_dir) + string(&(object_name[0])));
 
     hid_t dataset = H5Dopen(grp, &(object_name[0]), H5P_DEFAULT);
     hid_t dataspace = H5Dget_space(dataset);
     int ndims = H5Sget_simple_extent_ndims(dataspace);
-    vector<hsize_t> dims(ndims);
+    // scalars are treated as a single element
+    vector<hsize_t> dims(std::max(ndims, 1), 1);
     H5Sget_simple_extent_dims(dataspace, &(dims[0]), NULL);
     H5Sclose(dataspace);
 
-    data_sizes.push_back(accumulate(begin(dims), end(dims), 1, std::multiplies<hsize_t>()));
-
+    // the elements of array types are additional dimensions of their base type
     hid_t datatype = H5Dget_type(dataset);
-    if (H5Tequal(datatype, type_to_h5_type<float>()) > 0) {
-      data_types.push_back(H5_float);
-    }
-    else if (H5Tequal(datatype, type_to_h5_type<double>()) > 0) {
-      data_types.push_back(H5_double);
-    }
-    else if (H5Tequal(datatype, type_to_h5_type<cl_char>()) > 0) {
-      data_types.push_back(H5_char);
-    }
-    else if (H5Tequal(datatype, type_to_h5_type<cl_uchar>()) > 0) {
-      data_types.push_back(H5_uchar);
-    }
-    else if (H5Tequal(datatype, type_to_h5_type<cl_short>()) > 0) {
-      data_types.push_back(H5_short);
-    }
-    else if (H5Tequal(datatype, type_to_h5_type<cl_ushort>()) > 0) {
-      data_types.push_back(H5_ushort);
-    }
-    else if (H5Tequal(datatype, type_to_h5_type<cl_int>()) > 0) {
-      data_types.push_back(H5_int);
-    }
-    else if (H5Tequal(datatype, type_to_h5_type<cl_uint>()) > 0) {
-      data_types.push_back(H5_uint);
+    if (H5Tget_class(datatype) == H5T_ARRAY) {
+      int array_ndims = H5Tget_array_ndims(datatype);
+      vector<hsize_t> array_dims(array_ndims);
+      H5Tget_array_dims2(datatype, &(array_dims[0]));
+      dims.insert(dims.end(), array_dims.begin(), array_dims.end());
+
+      hid_t base_type = H5Tget_super(datatype);
+      H5Tclose(datatype);
+      datatype = base_type;
     }
-    else if (H5Tequal(datatype, type_to_h5_type<cl_long>()) > 0) {
-      data_types.push_back(H5_long);
+
+    data_sizes.push_back(accumulate(begin(dims), end(dims), 1, std::multiplies<hsize_t>()));
+    data_dims.push_back(vector<size_t>(begin(dims), end(dims)));
+
+    HD5_Type type;
+    if (H5Tget_class(datatype) == H5T_COMPOUND) {
+      data_types.push_back(H5_compound);
     }
-    else if (H5Tequal(datatype, type_to_h5_type<cl_ulong>()) > 0) {
-      data_types.push_back(H5_ulong);
+    else if (h5_get_type(datatype, type)) {
+      data_types.push_back(type);
     }
     else {
       std::cerr << ERROR_INFO << "Data type '" << datatype << "' unknown." << std::endl;
@@ -190,7 +463,82 @@ bool h5_get_content(char const* filename, char const* hdf_dir,
   }
 
   H5Gclose(grp);
-  H5Fclose(h5_file_id);
+  h5_close_file(h5_file_id);
+
+  return true;
+}
+
+
+bool h5_get_groups(char const* filename, char const* hdf_dir, std::vector<std::string>& group_names)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  hid_t grp = H5Gopen(h5_file_id, hdf_dir, H5P_DEFAULT);
+
+  hsize_t nobj;
+  H5Gget_num_objs(grp, &nobj);
+
+  for (hsize_t obj_idx = 0; obj_idx < nobj; obj_idx++) {
+    if (H5Gget_objtype_by_idx(grp, obj_idx) != H5G_GROUP) {
+      continue;
+    }
+
+    ssize_t len = H5Gget_objname_by_idx(grp, obj_idx, NULL, 0);
+    vector<char> object_name(len + 1, '\0');
+    H5Gget_objname_by_idx(grp, obj_idx, &(object_name[0]), len + 1);
+
+    group_names.push_back(string(hdf_dir) + string(&(object_name[0])));
+  }
+
+  H5Gclose(grp);
+  h5_close_file(h5_file_id);
+
+  return true;
+}
+
+
+bool h5_get_aliases(char const* filename, std::vector<std::string> const& data_names, std::vector<size_t>& data_aliases)
+{
+  return h5_get_aliases(std::vector<std::string>(data_names.size(), filename), data_names, data_aliases);
+}
+
+bool h5_get_aliases(std::vector<std::string> const& data_files, std::vector<std::string> const& data_names, std::vector<size_t>& data_aliases)
+{
+  // the files stay open, so that the identities of objects in the same file agree
+  std::map<std::string, hid_t> h5_file_ids;
+  for (std::string const& filename : data_files) {
+    if (h5_file_ids.count(filename) == 0) {
+      if (!fileExists(filename)) {
+        std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+        for (auto const& file : h5_file_ids) {
+          h5_close_file(file.second);
+        }
+        return false;
+      }
+      h5_file_ids[filename] = h5_open_file(filename.c_str(), H5F_ACC_RDONLY);
+    }
+  }
+
+  std::vector<std::string> identities;
+  data_aliases.clear();
+
+  for (size_t i = 0; i < data_names.size(); i++) {
+    H5O_type_t type;
+    std::string identity;
+    h5_get_object_info(h5_file_ids.at(data_files.at(i)), data_names.at(i).c_str(), type, identity);
+
+    auto it = std::find(identities.begin(), identities.end(), identity);
+    data_aliases.push_back(std::distance(identities.begin(), it));
+    identities.push_back(identity);
+  }
+
+  for (auto const& file : h5_file_ids) {
+    h5_close_file(file.second);
+  }
 
   return true;
 }
@@ -201,132 +549,2586 @@ bool h5_create_dir(char const* filename, char const* hdf_dir)
   hid_t h5_file_id, grp;
 
   if (fileExists(filename)) {
-    h5_file_id = H5Fopen(filename, H5F_ACC_RDWR, H5P_DEFAULT);
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
   }
   else {
-    h5_file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    h5_file_id = h5_create_file(filename);
   }
 
   if (H5LTpath_valid(h5_file_id, hdf_dir, true) <= 0) {
     grp = H5Gcreate1(h5_file_id, hdf_dir, 0);
     H5Gclose(grp);
   }
-  H5Fclose(h5_file_id);
+  h5_close_file(h5_file_id);
 
   return true;
 }
 
 
-// read a buffer from an HDF5 file
-template<typename TYPE>
-bool h5_read_buffer(char const* filename, char const* varname, TYPE* data)
+bool h5_create_external_link(char const* filename, char const* varname, char const* target_filename, char const* target_varname)
 {
-  if (!fileExists(filename)) {
-    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
-    //TODO: Exception? Only error code?
-    return false;
-  }
+  hid_t h5_file_id;
 
-  hid_t h5_file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
-  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
-    std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
-    //TODO: Exception? Only error code?
-    H5Fclose(h5_file_id);
-    return false;
+  if (fileExists(filename)) {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+  else {
+    h5_file_id = h5_create_file(filename);
   }
 
-  herr_t err = H5LTread_dataset(h5_file_id, varname, type_to_h5_type<TYPE>(), data);
+  herr_t err = H5Lcreate_external(target_filename, target_varname, h5_file_id, varname, H5P_DEFAULT, H5P_DEFAULT);
   if (err < 0) {
-    std::cerr << ERROR_INFO << "Reading variable '" << varname << "' in file '" << filename << "' not possible." << std::endl;
-    //TODO: Exception? Only error code?
-    H5Fclose(h5_file_id);
+    std::cerr << ERROR_INFO << "Creating link '" << varname << "' in file '" << filename << "' not possible." << std::endl;
+    h5_close_file(h5_file_id);
     return false;
   }
 
-  H5Fclose(h5_file_id);
+  h5_close_file(h5_file_id);
   return true;
 }
 
-// template instantiations
-template bool h5_read_buffer(char const* filename, char const* varname, float* data);
-template bool h5_read_buffer(char const* filename, char const* varname, double* data);
-template bool h5_read_buffer(char const* filename, char const* varname, cl_char* data);
-template bool h5_read_buffer(char const* filename, char const* varname, cl_uchar* data);
-template bool h5_read_buffer(char const* filename, char const* varname, cl_short* data);
-template bool h5_read_buffer(char const* filename, char const* varname, cl_ushort* data);
-template bool h5_read_buffer(char const* filename, char const* varname, cl_int* data);
-template bool h5_read_buffer(char const* filename, char const* varname, cl_uint* data);
-template bool h5_read_buffer(char const* filename, char const* varname, cl_long* data);
-template bool h5_read_buffer(char const* filename, char const* varname, cl_ulong* data);
-
 
-// write a buffer to an HDF5 file using compression
-template<typename TYPE>
-bool h5_write_buffer(char const* filename, char const* varname, TYPE const* data, size_t size, std::string const& description)
+bool h5_copy_object(char const* filename, char const* varname, char const* source_filename, char const* source_varname)
 {
-  hid_t   h5_file_id, dataset_id, dataspace_id;
-  hsize_t hdf_dims[2];
-  hid_t   plist_id;
-  hsize_t chunk_dims[2]; //chunk size used for compression
-  int ndims;
+  hid_t source_file_id = h5_open_file(source_filename, H5F_ACC_RDONLY);
+  if (source_file_id < 0) {
+    std::cerr << ERROR_INFO << "Opening file '" << source_filename << "' not possible." << std::endl;
+    return false;
+  }
 
-  if (!fileExists(filename)) {
-    h5_file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t h5_file_id;
+  if (fileExists(filename)) {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
   }
   else {
-    h5_file_id = H5Fopen(filename, H5F_ACC_RDWR, H5P_DEFAULT);
+    h5_file_id = h5_create_file(filename);
   }
 
-  hdf_dims[0] = size;
-  hdf_dims[1] = get_vector_size<TYPE>();
+  // links to other files within groups are replaced by copies, too
+  hid_t ocpypl_id = H5Pcreate(H5P_OBJECT_COPY);
+  H5Pset_copy_object(ocpypl_id, H5O_COPY_EXPAND_EXT_LINK_FLAG);
+  herr_t err = H5Ocopy(source_file_id, source_varname, h5_file_id, varname, ocpypl_id, H5P_DEFAULT);
+  H5Pclose(ocpypl_id);
+  h5_close_file(h5_file_id);
+  h5_close_file(source_file_id);
 
-  if (hdf_dims[1] == 1) {
-    ndims = 1;
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Copying '" << source_varname << "' of file '" << source_filename << "' to '"
+              << varname << "' in file '" << filename << "' not possible." << std::endl;
+    return false;
   }
-  else {
-    ndims = 2;
+  return true;
+}
+
+
+// names of the members of a group
+static std::vector<std::string> h5_get_members(hid_t loc_id, char const* name)
+{
+  std::vector<std::string> members;
+  hid_t grp = H5Gopen(loc_id, name, H5P_DEFAULT);
+  H5G_info_t info;
+  H5Gget_info(grp, &info);
+  for (hsize_t idx = 0; idx < info.nlinks; idx++) {
+    ssize_t len = H5Lget_name_by_idx(grp, ".", H5_INDEX_NAME, H5_ITER_INC, idx, NULL, 0, H5P_DEFAULT);
+    vector<char> member(len + 1, '\0');
+    H5Lget_name_by_idx(grp, ".", H5_INDEX_NAME, H5_ITER_INC, idx, &(member[0]), len + 1, H5P_DEFAULT);
+    members.push_back(&(member[0]));
   }
+  H5Gclose(grp);
+  return members;
+}
 
-  chunk_dims[0] = (hsize_t)(hdf_dims[0] / chunk_factor) + 1;
-  chunk_dims[1] = hdf_dims[1];
+// copy the attributes of the object `src_name` to `dst_name`, replacing attributes of the same name
+static void h5_copy_attributes(hid_t src_loc_id, char const* src_name, hid_t dst_loc_id, char const* dst_name)
+{
+  hid_t src = H5Oopen(src_loc_id, src_name, H5P_DEFAULT);
+  hid_t dst = H5Oopen(dst_loc_id, dst_name, H5P_DEFAULT);
+
+  H5O_info_t info;
+#if H5_VERSION_GE(1,10,3)
+  H5Oget_info2(src, &info, H5O_INFO_NUM_ATTRS);
+#else
+  H5Oget_info(src, &info);
+#endif
+  for (hsize_t idx = 0; idx < info.num_attrs; idx++) {
+    hid_t attribute = H5Aopen_by_idx(src, ".", H5_INDEX_NAME, H5_ITER_INC, idx, H5P_DEFAULT, H5P_DEFAULT);
+    ssize_t len = H5Aget_name(attribute, 0, NULL);
+    vector<char> name(len + 1, '\0');
+    H5Aget_name(attribute, len + 1, &(name[0]));
+    hid_t datatype = H5Aget_type(attribute);
+    hid_t dataspace = H5Aget_space(attribute);
+    hid_t mem_type = H5Tcopy(datatype);
+
+    // the attribute is copied without conversion; variable length data are read
+    // as pointers, which are written as they are
+    hssize_t num_elements = H5Sget_simple_extent_npoints(dataspace);
+    vector<uint8_t> data(std::max<size_t>(num_elements, 1) * H5Tget_size(mem_type));
+    H5Aread(attribute, mem_type, &(data[0]));
+
+    if (H5Aexists(dst, &(name[0])) > 0) {
+      H5Adelete(dst, &(name[0]));
+    }
+    hid_t copy = H5Acreate2(dst, &(name[0]), datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(copy, mem_type, &(data[0]));
+    H5Aclose(copy);
 
-  plist_id = H5Pcreate(H5P_DATASET_CREATE);
-  H5Pset_chunk(plist_id, ndims, chunk_dims);
-  H5Pset_deflate(plist_id, 9);
+    if (H5Tdetect_class(mem_type, H5T_VLEN) > 0 || H5Tis_variable_str(mem_type) > 0) {
+      H5Dvlen_reclaim(mem_type, dataspace, H5P_DEFAULT, &(data[0]));
+    }
+    H5Tclose(mem_type);
+    H5Sclose(dataspace);
+    H5Tclose(datatype);
+    H5Aclose(attribute);
+  }
 
-  dataspace_id = H5Screate_simple(ndims, hdf_dims, NULL);
-  dataset_id = H5Dcreate2(h5_file_id, varname , type_to_h5_type<TYPE>(), dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+  H5Oclose(dst);
+  H5Oclose(src);
+}
 
-  H5Dwrite(dataset_id, type_to_h5_type<TYPE>(), dataspace_id, dataspace_id, H5P_DEFAULT, data);
-  // The same can be done using H5 High Level API, but without compression
-  // H5LTmake_dataset(h5_file_id, varname, ndims, hdf_dims, type_to_h5_type<TYPE>(), data);
+static bool h5_is_group(hid_t loc_id, char const* name)
+{
+  H5O_type_t type;
+  std::string identity;
+  return h5_get_object_info(loc_id, name, type, identity) && type == H5O_TYPE_GROUP;
+}
 
-  if (!description.empty()) {
-    H5LTset_attribute_string(h5_file_id, varname, "description", description.c_str());
+// Replace an external link to a group by a group with the same attributes whose
+// members are external links to the members of the linked group, so that single
+// members can be replaced.
+static void h5_expand_group(hid_t merged_id, std::string const& name)
+{
+  H5L_info_t link_info;
+  if (H5Lget_info(merged_id, name.c_str(), &link_info, H5P_DEFAULT) < 0 || link_info.type != H5L_TYPE_EXTERNAL) {
+    return;
   }
 
-  H5Pclose(plist_id);
-  H5Dclose(dataset_id);
-  H5Sclose(dataspace_id);
+  vector<char> value(link_info.u.val_size);
+  H5Lget_val(merged_id, name.c_str(), &(value[0]), value.size(), H5P_DEFAULT);
+  char const* target_file = nullptr;
+  char const* target_name = nullptr;
+  H5Lunpack_elink_val(&(value[0]), value.size(), NULL, &target_file, &target_name);
+  std::string const filename(target_file), varname(target_name);
 
-  H5Fclose(h5_file_id);
+  hid_t target_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  H5Ldelete(merged_id, name.c_str(), H5P_DEFAULT);
+  hid_t grp = H5Gcreate(merged_id, name.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  H5Gclose(grp);
+  h5_copy_attributes(target_id, varname.c_str(), merged_id, name.c_str());
+  for (std::string const& member : h5_get_members(target_id, varname.c_str())) {
+    H5Lcreate_external(filename.c_str(), (varname + "/" + member).c_str(), merged_id, (name + "/" + member).c_str(),
+                       H5P_DEFAULT, H5P_DEFAULT);
+  }
+  H5Fclose(target_id);
+}
 
-  return true;
+// link the object `name` of a layer into the merged file, merging groups present in both
+static void h5_merge_object(hid_t merged_id, hid_t layer_id, std::string const& layer_filename, std::string const& name)
+{
+  if (H5Lexists(merged_id, name.c_str(), H5P_DEFAULT) > 0) {
+    if (h5_is_group(layer_id, name.c_str()) && h5_is_group(merged_id, name.c_str())) {
+      h5_expand_group(merged_id, name);
+      h5_copy_attributes(layer_id, name.c_str(), merged_id, name.c_str());
+      for (std::string const& member : h5_get_members(layer_id, name.c_str())) {
+        h5_merge_object(merged_id, layer_id, layer_filename, name + "/" + member);
+      }
+      return;
+    }
+    H5Ldelete(merged_id, name.c_str(), H5P_DEFAULT);
+  }
+  H5Lcreate_external(layer_filename.c_str(), name.c_str(), merged_id, name.c_str(), H5P_DEFAULT, H5P_DEFAULT);
 }
 
-// template instantiations
-template bool h5_write_buffer(char const* filename, char const* varname, float const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, double const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, cl_char const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, cl_uchar const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, cl_short const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, cl_ushort const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, cl_int const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, cl_uint const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, cl_long const* data, size_t size, std::string const& description);
-template bool h5_write_buffer(char const* filename, char const* varname, cl_ulong const* data, size_t size, std::string const& description);
+// split a list of values separated by commas
+static std::vector<std::string> split_values(std::string const& values)
+{
+  std::vector<std::string> items;
+  std::istringstream stream(values);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    items.push_back(item);
+  }
+  return items;
+}
 
+// Set the dataset `varname` to the values given as text. Numbers keep the type and
+// shape of the dataset they replace; new datasets are integers, floating point
+// numbers or strings, depending on the values.
+static bool h5_set_values(hid_t merged_id, std::string const& varname, std::string const& values)
+{
+  // the parents of the dataset are groups of the merged file
+  for (size_t pos = varname.find('/', 1); pos != std::string::npos; pos = varname.find('/', pos + 1)) {
+    std::string const parent = varname.substr(0, pos);
+    if (H5Lexists(merged_id, parent.c_str(), H5P_DEFAULT) <= 0) {
+      hid_t grp = H5Gcreate(merged_id, parent.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      H5Gclose(grp);
+    }
+    h5_expand_group(merged_id, parent);
+  }
 
+  std::vector<std::string> const items = split_values(values);
+  hid_t datatype = -1, dataspace = -1;
+  if (H5LTpath_valid(merged_id, varname.c_str(), true) > 0) {
+    hid_t dataset = H5Dopen(merged_id, varname.c_str(), H5P_DEFAULT);
+    datatype = H5Dget_type(dataset);
+    dataspace = H5Dget_space(dataset);
+    H5Dclose(dataset);
+    if (H5Tget_class(datatype) != H5T_STRING && H5Sget_simple_extent_npoints(dataspace) != (hssize_t)items.size()) {
+      std::cerr << ERROR_INFO << "Setting '" << varname << "' requires " << H5Sget_simple_extent_npoints(dataspace)
+                << " values." << std::endl;
+      H5Sclose(dataspace);
+      H5Tclose(datatype);
+      return false;
+    }
+  }
+  else {
+    bool integers = !items.empty(), numbers = !items.empty();
+    for (std::string const& item : items) {
+      char* end = nullptr;
+      std::strtoll(item.c_str(), &end, 0);
+      integers = integers && !item.empty() && *end == '\0';
+      std::strtod(item.c_str(), &end);
+      numbers = numbers && !item.empty() && *end == '\0';
+    }
+    datatype = H5Tcopy(integers ? H5T_NATIVE_LLONG : numbers ? H5T_NATIVE_DOUBLE : H5T_C_S1);
+    hsize_t size = items.size();
+    dataspace = H5Screate_simple(1, &size, NULL);
+  }
+  if (H5Lexists(merged_id, varname.c_str(), H5P_DEFAULT) > 0) {
+    H5Ldelete(merged_id, varname.c_str(), H5P_DEFAULT);
+  }
+
+  herr_t err = 0;
+  H5T_class_t const type_class = H5Tget_class(datatype);
+  if (type_class == H5T_STRING) {
+    err = H5LTmake_dataset_string(merged_id, varname.c_str(), values.c_str());
+  }
+  else {
+    hid_t dataset = H5Dcreate(merged_id, varname.c_str(), datatype, dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    try {
+      if (type_class == H5T_INTEGER && H5Tget_sign(datatype) == H5T_SGN_NONE) {
+        std::vector<unsigned long long> data;
+        for (std::string const& item : items) {
+          data.push_back(std::stoull(item, nullptr, 0));
+        }
+        err = H5Dwrite(dataset, H5T_NATIVE_ULLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, &(data[0]));
+      }
+      else if (type_class == H5T_INTEGER) {
+        std::vector<long long> data;
+        for (std::string const& item : items) {
+          data.push_back(std::stoll(item, nullptr, 0));
+        }
+        err = H5Dwrite(dataset, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, &(data[0]));
+      }
+      else {
+        std::vector<double> data;
+        for (std::string const& item : items) {
+          data.push_back(std::stod(item));
+        }
+        err = H5Dwrite(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, &(data[0]));
+      }
+    }
+    catch (std::exception const&) {
+      std::cerr << ERROR_INFO << "Could not convert '" << values << "' to numbers of setting '" << varname << "'." << std::endl;
+      err = -1;
+    }
+    H5Dclose(dataset);
+  }
+
+  H5Sclose(dataspace);
+  H5Tclose(datatype);
+  return err >= 0;
+}
+
+bool h5_merge_files(std::vector<std::string> const& filenames, std::vector<std::string> const& settings,
+                    char const* merged_filename)
+{
+  hid_t merged_id = H5Fcreate(merged_filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  if (merged_id < 0) {
+    std::cerr << ERROR_INFO << "Creating file '" << merged_filename << "' not possible." << std::endl;
+    return false;
+  }
+
+  bool success = true;
+  for (std::string const& filename : filenames) {
+    if (!fileExists(filename)) {
+      std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+      success = false;
+      break;
+    }
+    hid_t layer_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    h5_copy_attributes(layer_id, "/", merged_id, "/");
+    for (std::string const& member : h5_get_members(layer_id, "/")) {
+      h5_merge_object(merged_id, layer_id, filename, "/" + member);
+    }
+    H5Fclose(layer_id);
+  }
+
+  for (size_t idx = 0; success && idx < settings.size(); idx++) {
+    size_t const pos = settings.at(idx).find('=');
+    if (pos == std::string::npos || pos == 0) {
+      std::cerr << ERROR_INFO << "Setting '" << settings.at(idx) << "' is not of the form `name=value`." << std::endl;
+      success = false;
+      break;
+    }
+    std::string varname = settings.at(idx).substr(0, pos);
+    if (varname.front() != '/') {
+      varname = "/" + varname;
+    }
+    success = h5_set_values(merged_id, varname, settings.at(idx).substr(pos + 1));
+  }
+
+  H5Fclose(merged_id);
+  return success;
+}
+
+
+bool h5_create_hard_link(char const* filename, char const* varname, char const* target_varname)
+{
+  hid_t h5_file_id;
+
+  if (fileExists(filename)) {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+  else {
+    h5_file_id = h5_create_file(filename);
+  }
+
+  herr_t err = H5Lcreate_hard(h5_file_id, target_varname, h5_file_id, varname, H5P_DEFAULT, H5P_DEFAULT);
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Creating link '" << varname << "' in file '" << filename << "' not possible." << std::endl;
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  h5_close_file(h5_file_id);
+  return true;
+}
+
+
+bool h5_create_external_dataset(char const* filename, char const* varname, HD5_Type type, std::vector<size_t> const& dims,
+  char const* external_filename, size_t offset)
+{
+  hid_t h5_file_id;
+
+  if (fileExists(filename)) {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+  else {
+    h5_file_id = h5_create_file(filename);
+  }
+
+  vector<hsize_t> hdf_dims(dims.begin(), dims.end());
+  if (hdf_dims.empty()) {
+    hdf_dims.push_back(1);
+  }
+  size_t size = accumulate(hdf_dims.begin(), hdf_dims.end(), get_type_size(type), std::multiplies<size_t>());
+
+  hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_external(plist_id, external_filename, (off_t)offset, size);
+  hid_t dataspace_id = H5Screate_simple((int)hdf_dims.size(), &(hdf_dims[0]), NULL);
+  hid_t dataset_id = H5Dcreate2(h5_file_id, varname, type_to_h5_type(type), dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+  bool success = dataset_id >= 0;
+
+  H5Dclose(dataset_id);
+  H5Sclose(dataspace_id);
+  H5Pclose(plist_id);
+  h5_close_file(h5_file_id);
+
+  if (!success) {
+    std::cerr << ERROR_INFO << "Creating external dataset '" << varname << "' in file '" << filename << "' not possible." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+// reading and writing string attributes attached to an object
+bool h5_check_attribute(char const* filename, char const* varname, char const* attr_name)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+
+  bool found = (H5LTpath_valid(h5_file_id, varname, true) > 0)
+            && (H5Aexists_by_name(h5_file_id, varname, attr_name, H5P_DEFAULT) > 0);
+
+  h5_close_file(h5_file_id);
+  return found;
+}
+
+bool h5_read_attribute_string(char const* filename, char const* varname, char const* attr_name, std::string& value)
+{
+  if (!h5_check_attribute(filename, varname, attr_name)) {
+    std::cerr << ERROR_INFO << "Attribute '" << attr_name << "' of '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  hid_t attr = H5Aopen_by_name(h5_file_id, varname, attr_name, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t datatype = H5Aget_type(attr);
+
+  herr_t err;
+  if (H5Tis_variable_str(datatype) > 0) {
+    // variable length strings are written by default by h5py and HDF5.jl
+    char* buffer = nullptr;
+    err = H5Aread(attr, datatype, &buffer);
+    if (err >= 0 && buffer != nullptr) {
+      value = std::string(buffer);
+      H5free_memory(buffer);
+    }
+  }
+  else {
+    std::vector<char> buffer(H5Tget_size(datatype) + 1, '\0');
+    err = H5Aread(attr, datatype, &(buffer[0]));
+    value = std::string(&(buffer[0]));
+  }
+
+  H5Tclose(datatype);
+  H5Aclose(attr);
+  h5_close_file(h5_file_id);
+
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Reading attribute '" << attr_name << "' of '" << varname << "' in file '" << filename << "' not possible." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool h5_write_attribute_string(char const* filename, char const* varname, char const* attr_name, std::string const& value)
+{
+  hid_t h5_file_id;
+
+  if (!fileExists(filename)) {
+    h5_file_id = h5_create_file(filename);
+  }
+  else {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+
+  herr_t err = H5LTset_attribute_string(h5_file_id, varname, attr_name, value.c_str());
+
+  h5_close_file(h5_file_id);
+
+  return err >= 0;
+}
+
+
+// reading and writing scalar numeric attributes attached to an object
+template<typename TYPE>
+bool h5_read_attribute(char const* filename, char const* varname, char const* attr_name, TYPE& value)
+{
+  if (!h5_check_attribute(filename, varname, attr_name)) {
+    std::cerr << ERROR_INFO << "Attribute '" << attr_name << "' of '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  hid_t attr = H5Aopen_by_name(h5_file_id, varname, attr_name, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t attr_space = H5Aget_space(attr);
+
+  // the HDF5 library converts the stored type to TYPE if necessary
+  herr_t err = -1;
+  if (H5Sget_simple_extent_npoints(attr_space) == 1) {
+    err = H5Aread(attr, type_to_h5_type<TYPE>(), &value);
+  }
+
+  H5Sclose(attr_space);
+  H5Aclose(attr);
+  h5_close_file(h5_file_id);
+
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Reading attribute '" << attr_name << "' of '" << varname << "' in file '" << filename << "' not possible." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+template<typename TYPE>
+bool h5_write_attribute(char const* filename, char const* varname, char const* attr_name, TYPE value)
+{
+  hid_t h5_file_id;
+
+  if (!fileExists(filename)) {
+    h5_file_id = h5_create_file(filename);
+  }
+  else {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+
+  hid_t attr_space = H5Screate(H5S_SCALAR);
+  hid_t attr = H5Acreate_by_name(h5_file_id, varname, attr_name, type_to_h5_type<TYPE>(), attr_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  herr_t err = H5Awrite(attr, type_to_h5_type<TYPE>(), &value);
+
+  H5Aclose(attr);
+  H5Sclose(attr_space);
+  h5_close_file(h5_file_id);
+
+  return err >= 0;
+}
+
+// template instantiations
+template bool h5_read_attribute(char const* filename, char const* varname, char const* attr_name, float& value);
+template bool h5_read_attribute(char const* filename, char const* varname, char const* attr_name, double& value);
+template bool h5_read_attribute(char const* filename, char const* varname, char const* attr_name, cl_int& value);
+template bool h5_read_attribute(char const* filename, char const* varname, char const* attr_name, cl_uint& value);
+template bool h5_read_attribute(char const* filename, char const* varname, char const* attr_name, cl_long& value);
+template bool h5_read_attribute(char const* filename, char const* varname, char const* attr_name, cl_ulong& value);
+
+template bool h5_write_attribute(char const* filename, char const* varname, char const* attr_name, float value);
+template bool h5_write_attribute(char const* filename, char const* varname, char const* attr_name, double value);
+template bool h5_write_attribute(char const* filename, char const* varname, char const* attr_name, cl_int value);
+template bool h5_write_attribute(char const* filename, char const* varname, char const* attr_name, cl_uint value);
+template bool h5_write_attribute(char const* filename, char const* varname, char const* attr_name, cl_long value);
+template bool h5_write_attribute(char const* filename, char const* varname, char const* attr_name, cl_ulong value);
+
+
+// target size in bytes of the chunks of written datasets
+static size_t chunk_size = 1 << 20;
+// HDF5 limits the size of a chunk to 4 GiB
+static const size_t max_chunk_size = ((size_t)1 << 32) - 1;
+
+void h5_set_chunk_size(size_t size)
+{
+  chunk_size = std::min(std::max(size, (size_t)1), max_chunk_size);
+}
+
+size_t h5_get_chunk_size()
+{
+  return chunk_size;
+}
+
+// Chunk dimensions of a dataset with dimensions `dims` and elements of
+// `element_size` bytes. The dimensions `chunk_dims` of the leading dimensions
+// (e.g. of the input dataset) are used if they are within the limit of HDF5.
+// Otherwise, the largest dimension (the slowest varying one of equal dimensions)
+// is halved until a chunk is not larger than the target size. Thus, chunks of
+// multidimensional datasets are blocks rather than slabs and short trailing
+// dimensions, e.g. the components of vector types, are kept whole.
+static vector<hsize_t> h5_chunk_dims(vector<hsize_t> const& dims, size_t element_size, vector<size_t> const& chunk_dims)
+{
+  vector<hsize_t> hdf_chunk_dims(dims);
+  for (size_t dim = 0; dim < std::min(chunk_dims.size(), dims.size()); ++dim) {
+    hdf_chunk_dims[dim] = std::max((hsize_t)1, std::min((hsize_t)chunk_dims[dim], dims[dim]));
+  }
+  size_t bytes = accumulate(hdf_chunk_dims.begin(), hdf_chunk_dims.end(), element_size, std::multiplies<size_t>());
+  if (!chunk_dims.empty() && bytes <= max_chunk_size) {
+    return hdf_chunk_dims;
+  }
+
+  for (size_t dim = 0; dim < dims.size(); ++dim) {
+    hdf_chunk_dims[dim] = std::max((hsize_t)1, dims[dim]);
+  }
+  bytes = accumulate(hdf_chunk_dims.begin(), hdf_chunk_dims.end(), element_size, std::multiplies<size_t>());
+  while (bytes > chunk_size) {
+    vector<hsize_t>::iterator largest = std::max_element(hdf_chunk_dims.begin(), hdf_chunk_dims.end());
+    if (*largest == 1) {
+      break;
+    }
+    *largest = (*largest + 1) / 2;
+    bytes = accumulate(hdf_chunk_dims.begin(), hdf_chunk_dims.end(), element_size, std::multiplies<size_t>());
+  }
+  return hdf_chunk_dims;
+}
+
+
+// access property list of datasets whose external storage files, e.g. the .npy
+// files of the `npy` output, are named relative to the directory of the HDF5 file
+// ("${ORIGIN}"), unless HDF5_EXTFILE_PREFIX is set
+static hid_t h5_dataset_access()
+{
+  hid_t dapl_id = H5Pcreate(H5P_DATASET_ACCESS);
+#if H5_VERSION_GE(1, 10, 0)
+  H5Pset_efile_prefix(dapl_id, "${ORIGIN}");
+#endif
+  return dapl_id;
+}
+
+// Open a dataset with a chunk cache holding the chunks of a slab along the
+// slowest varying dimension (within bounds), so that partial reads decompress
+// every chunk only once. The default cache of 1 MiB is used for other datasets.
+static hid_t h5_open_dataset(hid_t loc_id, char const* varname)
+{
+  hid_t dapl_id = h5_dataset_access();
+  hid_t dataset = H5Dopen(loc_id, varname, dapl_id);
+  H5Pclose(dapl_id);
+  if (dataset < 0) {
+    return dataset;
+  }
+
+  hid_t plist_id = H5Dget_create_plist(dataset);
+  size_t cache_bytes = 0, cache_chunks = 0;
+  if (H5Pget_layout(plist_id) == H5D_CHUNKED) {
+    hid_t dataspace = H5Dget_space(dataset);
+    hid_t datatype = H5Dget_type(dataset);
+    int ndims = H5Sget_simple_extent_ndims(dataspace);
+    vector<hsize_t> dims(std::max(ndims, 1), 1), hdf_chunk_dims(std::max(ndims, 1), 1);
+    H5Sget_simple_extent_dims(dataspace, &(dims[0]), NULL);
+    H5Pget_chunk(plist_id, ndims, &(hdf_chunk_dims[0]));
+
+    size_t bytes = accumulate(hdf_chunk_dims.begin(), hdf_chunk_dims.end(), H5Tget_size(datatype), std::multiplies<size_t>());
+    size_t chunks_per_slab = 1;
+    for (size_t dim = 1; dim < dims.size(); ++dim) {
+      chunks_per_slab *= (dims[dim] + hdf_chunk_dims[dim] - 1) / std::max(hdf_chunk_dims[dim], (hsize_t)1);
+    }
+    cache_chunks = std::max((size_t)1, std::min(chunks_per_slab, ((size_t)64 << 20) / std::max(bytes, (size_t)1)));
+    cache_bytes = cache_chunks * bytes;
+
+    H5Tclose(datatype);
+    H5Sclose(dataspace);
+  }
+  H5Pclose(plist_id);
+
+  if (cache_bytes <= ((size_t)1 << 20)) {
+    return dataset;
+  }
+
+  // about 100 hash slots per cached chunk; a prime number reduces collisions
+  size_t slots = std::max((size_t)521, 100 * cache_chunks) | 1;
+  for (bool prime = false; !prime; slots += 2) {
+    prime = true;
+    for (size_t divisor = 3; divisor * divisor <= slots; divisor += 2) {
+      if (slots % divisor == 0) {
+        prime = false;
+        break;
+      }
+    }
+    if (prime) {
+      break;
+    }
+  }
+
+  H5Dclose(dataset);
+  dapl_id = h5_dataset_access();
+  H5Pset_chunk_cache(dapl_id, slots, cache_bytes, 0.75);
+  dataset = H5Dopen(loc_id, varname, dapl_id);
+  H5Pclose(dapl_id);
+
+  return dataset;
+}
+
+
+// number of threads (de)compressing the chunks of a dataset
+static unsigned int num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+void h5_set_threads(unsigned int threads)
+{
+  num_threads = std::max(threads, 1u);
+}
+
+unsigned int h5_get_threads()
+{
+  return num_threads;
+}
+
+// check whether a filter chain consists of shuffle and deflate filters only,
+// which are applied by `h5_write_chunks` and `h5_read_chunks` on several threads
+static bool is_parallel_chain(vector<H5Z_filter_t> const& filters)
+{
+  bool deflate = false;
+  for (H5Z_filter_t filter : filters) {
+    if (filter == H5Z_FILTER_DEFLATE) {
+      deflate = true;
+    }
+    else if (filter != H5Z_FILTER_SHUFFLE) {
+      return false;
+    }
+  }
+  return deflate;
+}
+
+// chunks of a dataset filtered by shuffle and deflate, numbered in row major
+// order of the grid of chunks
+struct chunk_layout {
+  vector<hsize_t> dims;
+  vector<hsize_t> chunk_dims;
+  vector<hsize_t> grid;
+  size_t element_size;
+  size_t num_chunks;
+  size_t chunk_elements;
+  vector<H5Z_filter_t> filters;
+  unsigned int level;
+};
+
+// get the chunk layout of a dataset; false if the chunks cannot be (de)compressed
+// in parallel, i.e. for other filters, a single chunk or a single thread
+static bool h5_get_chunk_layout(hid_t dataset_id, chunk_layout& layout)
+{
+  if (num_threads < 2) {
+    return false;
+  }
+
+  hid_t plist_id = H5Dget_create_plist(dataset_id);
+  if (H5Pget_layout(plist_id) != H5D_CHUNKED) {
+    H5Pclose(plist_id);
+    return false;
+  }
+  layout.filters.clear();
+  layout.level = 6;
+  for (int idx = 0; idx < H5Pget_nfilters(plist_id); ++idx) {
+    unsigned int flags, cd_values[8];
+    size_t cd_nelmts = 8;
+    layout.filters.push_back(H5Pget_filter2(plist_id, idx, &flags, &cd_nelmts, cd_values, 0, NULL, NULL));
+    if (layout.filters.back() == H5Z_FILTER_DEFLATE && cd_nelmts > 0) {
+      layout.level = cd_values[0];
+    }
+  }
+
+  hid_t dataspace_id = H5Dget_space(dataset_id);
+  hid_t datatype = H5Dget_type(dataset_id);
+  int ndims = H5Sget_simple_extent_ndims(dataspace_id);
+  layout.dims.assign(std::max(ndims, 1), 1);
+  layout.chunk_dims.assign(std::max(ndims, 1), 1);
+  H5Sget_simple_extent_dims(dataspace_id, &(layout.dims[0]), NULL);
+  H5Pget_chunk(plist_id, ndims, &(layout.chunk_dims[0]));
+  layout.element_size = H5Tget_size(datatype);
+  H5Tclose(datatype);
+  H5Sclose(dataspace_id);
+  H5Pclose(plist_id);
+
+  layout.grid.resize(layout.dims.size());
+  for (size_t dim = 0; dim < layout.dims.size(); ++dim) {
+    layout.grid[dim] = (layout.dims[dim] + layout.chunk_dims[dim] - 1) / layout.chunk_dims[dim];
+  }
+  layout.num_chunks = accumulate(layout.grid.begin(), layout.grid.end(), (size_t)1, std::multiplies<size_t>());
+  layout.chunk_elements = accumulate(layout.chunk_dims.begin(), layout.chunk_dims.end(), (size_t)1, std::multiplies<size_t>());
+
+  return is_parallel_chain(layout.filters) && layout.num_chunks > 1;
+}
+
+static vector<hsize_t> chunk_offset(chunk_layout const& layout, size_t chunk)
+{
+  vector<hsize_t> offset(layout.dims.size());
+  for (size_t dim = layout.dims.size(), rest = chunk; dim-- > 0; rest /= layout.grid[dim]) {
+    offset[dim] = (rest % layout.grid[dim]) * layout.chunk_dims[dim];
+  }
+  return offset;
+}
+
+// copy the rows of the chunk at `offset` from `data` to `chunk` (padded with
+// zeros at the edges of the dataset) or, if `gather` is false, back to `data`
+static void copy_chunk(chunk_layout const& layout, vector<hsize_t> const& offset, uint8_t* chunk, uint8_t* data, bool gather)
+{
+  size_t ndims = layout.dims.size();
+  size_t row_length = layout.chunk_dims.back();
+  size_t row_bytes = std::min(row_length, (size_t)(layout.dims.back() - offset.back())) * layout.element_size;
+  if (gather) {
+    memset(chunk, 0, layout.chunk_elements * layout.element_size);
+  }
+
+  vector<hsize_t> pos(ndims, 0);
+  for (size_t row = 0; row < layout.chunk_elements / row_length; ++row) {
+    for (size_t dim = ndims - 1, rest = row; dim-- > 0; rest /= layout.chunk_dims[dim]) {
+      pos[dim] = rest % layout.chunk_dims[dim];
+    }
+    size_t idx = 0;
+    bool inside = true;
+    for (size_t dim = 0; dim < ndims; ++dim) {
+      hsize_t coord = offset[dim] + (dim + 1 < ndims ? pos[dim] : 0);
+      inside = inside && coord < layout.dims[dim];
+      idx = idx * layout.dims[dim] + coord;
+    }
+    if (!inside) {
+      continue;
+    }
+    uint8_t* chunk_row = chunk + row * row_length * layout.element_size;
+    if (gather) {
+      memcpy(chunk_row, data + idx * layout.element_size, row_bytes);
+    }
+    else {
+      memcpy(data + idx * layout.element_size, chunk_row, row_bytes);
+    }
+  }
+}
+
+// the byte shuffle of HDF5 stores the k-th bytes of all elements consecutively
+static void shuffle_bytes(uint8_t const* src, uint8_t* dst, size_t num_elements, size_t element_size, bool shuffle)
+{
+  for (size_t byte = 0; byte < element_size; ++byte) {
+    for (size_t idx = 0; idx < num_elements; ++idx) {
+      if (shuffle) {
+        dst[byte * num_elements + idx] = src[idx * element_size + byte];
+      }
+      else {
+        dst[idx * element_size + byte] = src[byte * num_elements + idx];
+      }
+    }
+  }
+}
+
+
+// number of chunks held in memory between the calling thread and the threads
+// (de)compressing them
+static size_t chunk_window()
+{
+  return 2 * (size_t)num_threads;
+}
+
+// Write the chunks of a dataset compressed on `num_threads` threads. Every
+// chunk is copied from `data`, filtered in the same format as the shuffle and
+// deflate filters of HDF5 and written by the calling thread using direct chunk
+// writes, in the order of the chunks. The compressing threads run at most
+// `chunk_window()` chunks ahead of the writes. Returns false without writing if
+// the chunks cannot be compressed in parallel; the caller uses H5Dwrite then.
+static bool h5_write_chunks(hid_t dataset_id, void const* data)
+{
+  chunk_layout layout;
+  if (!h5_get_chunk_layout(dataset_id, layout)) {
+    return false;
+  }
+  size_t chunk_bytes = layout.chunk_elements * layout.element_size;
+
+  vector<vector<uint8_t>> chunks(layout.num_chunks);
+  vector<char> done(layout.num_chunks, false), failed(layout.num_chunks, false);
+  std::atomic<size_t> next_chunk(0);
+  size_t num_written = 0;
+  std::mutex mutex;
+  std::condition_variable chunk_done, chunk_written;
+
+  auto compress_chunks = [&]() {
+    vector<uint8_t> buffer, shuffled;
+    for (size_t chunk = next_chunk++; chunk < layout.num_chunks; chunk = next_chunk++) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        chunk_written.wait(lock, [&]() { return chunk < num_written + chunk_window(); });
+      }
+      buffer.resize(chunk_bytes);
+      shuffled.resize(chunk_bytes);
+      copy_chunk(layout, chunk_offset(layout, chunk), &(buffer[0]), (uint8_t*)data, true);
+
+      bool ok = true;
+      for (H5Z_filter_t filter : layout.filters) {
+        if (filter == H5Z_FILTER_SHUFFLE) {
+          shuffle_bytes(&(buffer[0]), &(shuffled[0]), layout.chunk_elements, layout.element_size, true);
+        }
+        else {
+          uLongf size = compressBound(buffer.size());
+          shuffled.resize(size);
+          ok = ok && compress2(&(shuffled[0]), &size, &(buffer[0]), buffer.size(), layout.level) == Z_OK;
+          shuffled.resize(size);
+        }
+        buffer.swap(shuffled);
+      }
+      chunks[chunk].swap(buffer);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      done[chunk] = true;
+      failed[chunk] = !ok;
+      chunk_done.notify_one();
+    }
+  };
+
+  vector<std::thread> threads;
+  for (unsigned int idx = 0; idx < std::min((size_t)num_threads, layout.num_chunks); ++idx) {
+    threads.push_back(std::thread(compress_chunks));
+  }
+
+  // the HDF5 library is used by the calling thread only
+  bool success = true;
+  for (size_t chunk = 0; chunk < layout.num_chunks; ++chunk) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      chunk_done.wait(lock, [&]() { return done[chunk] != 0; });
+    }
+    success = success && !failed[chunk];
+    if (success) {
+      vector<hsize_t> offset = chunk_offset(layout, chunk);
+#if H5_VERSION_GE(1, 10, 2)
+      success = H5Dwrite_chunk(dataset_id, H5P_DEFAULT, 0, &(offset[0]), chunks[chunk].size(), &(chunks[chunk][0])) >= 0;
+#else
+      success = H5DOwrite_chunk(dataset_id, H5P_DEFAULT, 0, &(offset[0]), chunks[chunk].size(), &(chunks[chunk][0])) >= 0;
+#endif
+    }
+    vector<uint8_t>().swap(chunks[chunk]);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++num_written;
+    chunk_written.notify_all();
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return success;
+}
+
+
+// Read all chunks of a dataset into `data` of the type of the dataset,
+// decompressed on `num_threads` threads. The raw chunks are read by the calling
+// thread using direct chunk reads while the previous chunks are inflated,
+// unshuffled and copied to `data`; at most `chunk_window()` raw chunks are read
+// ahead of the decompressing threads. Returns false if the chunks cannot be
+// decompressed in parallel or not all chunks are allocated (so the fill value
+// applies); the caller uses H5Dread then.
+static bool h5_read_chunks(hid_t dataset_id, void* data)
+{
+#if H5_VERSION_GE(1, 10, 5)
+  chunk_layout layout;
+  if (!h5_get_chunk_layout(dataset_id, layout)) {
+    return false;
+  }
+  size_t chunk_bytes = layout.chunk_elements * layout.element_size;
+
+  hid_t dataspace_id = H5Dget_space(dataset_id);
+  hsize_t num_allocated = 0;
+  H5Dget_num_chunks(dataset_id, dataspace_id, &num_allocated);
+  if (num_allocated != layout.num_chunks) {
+    H5Sclose(dataspace_id);
+    return false;
+  }
+
+  vector<vector<uint8_t>> chunks(layout.num_chunks);
+  vector<vector<hsize_t>> offsets(layout.num_chunks);
+  vector<uint32_t> masks(layout.num_chunks, 0);
+  vector<char> ready(layout.num_chunks, false);
+  std::atomic<size_t> next_chunk(0);
+  std::atomic<bool> failed(false);
+  size_t num_pending = 0;
+  std::mutex mutex;
+  std::condition_variable chunk_ready, chunk_taken;
+
+  auto decompress_chunks = [&]() {
+    vector<uint8_t> buffer, unshuffled;
+    for (size_t chunk = next_chunk++; chunk < layout.num_chunks; chunk = next_chunk++) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        chunk_ready.wait(lock, [&]() { return ready[chunk] != 0; });
+        buffer.swap(chunks[chunk]);
+        vector<uint8_t>().swap(chunks[chunk]);
+        --num_pending;
+        chunk_taken.notify_one();
+      }
+
+      // the filters are reverted in reverse order, skipping those disabled for the chunk
+      bool ok = !buffer.empty();
+      for (size_t idx = layout.filters.size(); ok && idx-- > 0; ) {
+        if (masks[chunk] & (1u << idx)) {
+          continue;
+        }
+        unshuffled.resize(chunk_bytes);
+        if (layout.filters[idx] == H5Z_FILTER_SHUFFLE) {
+          ok = buffer.size() == chunk_bytes;
+          if (ok) {
+            shuffle_bytes(&(buffer[0]), &(unshuffled[0]), layout.chunk_elements, layout.element_size, false);
+          }
+        }
+        else {
+          uLongf size = chunk_bytes;
+          ok = uncompress(&(unshuffled[0]), &size, &(buffer[0]), buffer.size()) == Z_OK && size == chunk_bytes;
+        }
+        buffer.swap(unshuffled);
+      }
+      ok = ok && buffer.size() == chunk_bytes;
+
+      if (ok) {
+        copy_chunk(layout, offsets[chunk], &(buffer[0]), (uint8_t*)data, false);
+      }
+      else {
+        failed = true;
+      }
+    }
+  };
+
+  vector<std::thread> threads;
+  for (unsigned int idx = 0; idx < std::min((size_t)num_threads, layout.num_chunks); ++idx) {
+    threads.push_back(std::thread(decompress_chunks));
+  }
+
+  // the HDF5 library is used by the calling thread only; chunks are read in
+  // the order of their index in the file, which need not be the grid order
+  for (size_t chunk = 0; chunk < layout.num_chunks; ++chunk) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      chunk_taken.wait(lock, [&]() { return num_pending < chunk_window(); });
+    }
+    vector<hsize_t> offset(layout.dims.size());
+    unsigned int mask = 0;
+    haddr_t address;
+    hsize_t size = 0;
+    vector<uint8_t> raw;
+    if (!failed && H5Dget_chunk_info(dataset_id, dataspace_id, chunk, &(offset[0]), &mask, &address, &size) >= 0) {
+      raw.resize(size);
+      uint32_t filter_mask = 0;
+#if H5_VERSION_GE(1, 10, 3)
+      if (size == 0 || H5Dread_chunk(dataset_id, H5P_DEFAULT, &(offset[0]), &filter_mask, &(raw[0])) < 0) {
+#else
+      if (size == 0 || H5DOread_chunk(dataset_id, H5P_DEFAULT, &(offset[0]), &filter_mask, &(raw[0])) < 0) {
+#endif
+        raw.clear();
+      }
+      mask = filter_mask;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    chunks[chunk].swap(raw);
+    offsets[chunk] = offset;
+    masks[chunk] = mask;
+    ready[chunk] = true;
+    ++num_pending;
+    chunk_ready.notify_all();
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  H5Sclose(dataspace_id);
+  return !failed;
+#else
+  return false;
+#endif
+}
+
+
+// read a buffer from an HDF5 file
+template<typename TYPE>
+bool h5_read_buffer(char const* filename, char const* varname, TYPE* data)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    //TODO: Exception? Only error code?
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
+    std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    //TODO: Exception? Only error code?
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  hid_t dataset = h5_open_dataset(h5_file_id, varname);
+  hid_t datatype = H5Dget_type(dataset);
+  herr_t err = 0;
+  if (H5Tequal(datatype, type_to_h5_type<TYPE>()) <= 0 || !h5_read_chunks(dataset, data)) {
+    err = H5Dread(dataset, type_to_h5_type<TYPE>(), H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+  }
+  H5Tclose(datatype);
+  H5Dclose(dataset);
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Reading variable '" << varname << "' in file '" << filename << "' not possible." << std::endl;
+    //TODO: Exception? Only error code?
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  h5_close_file(h5_file_id);
+  return true;
+}
+
+// template instantiations
+template bool h5_read_buffer(char const* filename, char const* varname, float* data);
+template bool h5_read_buffer(char const* filename, char const* varname, double* data);
+template bool h5_read_buffer(char const* filename, char const* varname, cl_char* data);
+template bool h5_read_buffer(char const* filename, char const* varname, cl_uchar* data);
+template bool h5_read_buffer(char const* filename, char const* varname, cl_short* data);
+template bool h5_read_buffer(char const* filename, char const* varname, cl_ushort* data);
+template bool h5_read_buffer(char const* filename, char const* varname, cl_int* data);
+template bool h5_read_buffer(char const* filename, char const* varname, cl_uint* data);
+template bool h5_read_buffer(char const* filename, char const* varname, cl_long* data);
+template bool h5_read_buffer(char const* filename, char const* varname, cl_ulong* data);
+
+
+// compression of the datasets written subsequently; deflate at level 9 by default
+static H5_Compression default_compression()
+{
+  H5_Compression compression;
+  compression.filters.push_back(H5Z_FILTER_DEFLATE);
+  compression.params.push_back(vector<unsigned int>(1, 9));
+  return compression;
+}
+
+static H5_Compression current_compression = default_compression();
+
+// identifiers of common filter plugins registered with the HDF Group
+static bool plugin_filter(string const& name, H5Z_filter_t& filter)
+{
+  if      (name == "bzip2")      { filter = 307; }
+  else if (name == "lzf")        { filter = 32000; }
+  else if (name == "blosc")      { filter = 32001; }
+  else if (name == "lz4")        { filter = 32004; }
+  else if (name == "bitshuffle") { filter = 32008; }
+  else if (name == "zstd")       { filter = 32015; }
+  else {
+    return false;
+  }
+  return true;
+}
+
+bool h5_parse_compression(std::string const& spec, H5_Compression& compression)
+{
+  compression = H5_Compression();
+
+  std::istringstream filters(spec);
+  string filter_spec;
+  while (getline(filters, filter_spec, ',')) {
+    // the name is followed by numeric parameters separated by colons
+    std::istringstream parts(filter_spec);
+    string name, part;
+    getline(parts, name, ':');
+    vector<unsigned int> params;
+    try {
+      while (getline(parts, part, ':')) {
+        params.push_back(stoul(part));
+      }
+    }
+    catch (std::exception const&) {
+      std::cerr << ERROR_INFO << "Invalid parameter '" << part << "' of the compression '" << filter_spec << "'." << std::endl;
+      return false;
+    }
+
+    H5Z_filter_t filter;
+    if (name == "none" || name.empty()) {
+      continue;
+    }
+    else if (name == "auto") {
+      compression.automatic = true;
+      if (!params.empty()) {
+        compression.min_throughput = params.at(0);
+      }
+      continue;
+    }
+    else if (name == "deflate" || name == "gzip") {
+      filter = H5Z_FILTER_DEFLATE;
+    }
+    else if (name == "shuffle") {
+      filter = H5Z_FILTER_SHUFFLE;
+    }
+    else if (name == "scaleoffset") {
+      filter = H5Z_FILTER_SCALEOFFSET;
+    }
+    else if (name == "filter" && !params.empty()) {
+      filter = params.at(0);
+      params.erase(params.begin());
+    }
+    else if (!plugin_filter(name, filter)) {
+      std::cerr << ERROR_INFO << "Unknown compression '" << filter_spec << "'." << std::endl;
+      return false;
+    }
+
+    // the built-in filters are checked regardless of whether they are given by name or identifier
+    if (filter == H5Z_FILTER_DEFLATE) {
+      if (params.empty()) {
+        params.push_back(6);
+      }
+      if (params.size() > 1 || params.at(0) < 1 || params.at(0) > 9) {
+        std::cerr << ERROR_INFO << "Deflate level of the compression '" << filter_spec << "' is not in [1, 9]." << std::endl;
+        return false;
+      }
+    }
+    else if (filter == H5Z_FILTER_SHUFFLE && !params.empty()) {
+      std::cerr << ERROR_INFO << "The compression '" << filter_spec << "' takes no parameters." << std::endl;
+      return false;
+    }
+    else if (filter == H5Z_FILTER_SCALEOFFSET && params.size() > 1) {
+      std::cerr << ERROR_INFO << "The compression '" << filter_spec << "' takes at most one parameter." << std::endl;
+      return false;
+    }
+
+    compression.filters.push_back(filter);
+    compression.params.push_back(params);
+  }
+
+  return true;
+}
+
+void h5_set_compression(H5_Compression const& compression)
+{
+  current_compression = compression;
+}
+
+H5_Compression const& h5_get_compression()
+{
+  return current_compression;
+}
+
+
+// the warning about skipped scale-offset filters is shown only once
+static bool scaleoffset_warned = false;
+
+// add the filters of `compression` to the dataset creation property list `plist_id`
+// of a chunked dataset of type `type`; filters not applicable to the type are skipped
+static void h5_add_filters(hid_t plist_id, hid_t type, H5_Compression const& compression)
+{
+  H5T_class_t type_class = H5Tget_class(type);
+  size_t type_size = H5Tget_size(type);
+
+  for (size_t idx = 0; idx < compression.filters.size(); ++idx) {
+    H5Z_filter_t filter = compression.filters.at(idx);
+    vector<unsigned int> const& params = compression.params.at(idx);
+
+    if (filter == H5Z_FILTER_DEFLATE) {
+      H5Pset_deflate(plist_id, params.empty() ? 6 : params.at(0));
+    }
+    else if (filter == H5Z_FILTER_SHUFFLE) {
+      H5Pset_shuffle(plist_id);
+    }
+    else if (filter == H5Z_FILTER_SCALEOFFSET) {
+      // scale-offset is lossless for integers only and supports single and double precision
+      if (type_class == H5T_INTEGER) {
+        H5Pset_scaleoffset(plist_id, H5Z_SO_INT, H5Z_SO_INT_MINBITS_DEFAULT);
+      }
+      else if (type_class == H5T_FLOAT && (type_size == 4 || type_size == 8) && !params.empty()) {
+        H5Pset_scaleoffset(plist_id, H5Z_SO_FLOAT_DSCALE, params.at(0));
+      }
+      else if (type_class == H5T_FLOAT && !scaleoffset_warned) {
+        scaleoffset_warned = true;
+        std::cout << "Warning: scaleoffset is skipped for floating point datasets"
+                  << (params.empty() ? " unless the number of digits is given, e.g. `scaleoffset:3`." : " of half precision.")
+                  << std::endl;
+      }
+    }
+    else if (H5Zfilter_avail(filter) > 0) {
+      // plugins may fail for some chunks, which are stored uncompressed then
+      H5Pset_filter(plist_id, filter, H5Z_FLAG_OPTIONAL, params.size(), params.data());
+    }
+  }
+}
+
+
+// size in bytes of the sample used to select the filters of a dataset automatically
+static const size_t compression_sample_size = 1 << 20;
+
+// Compress `size` bytes of elements of type `type` in a file in memory; get the
+// compression ratio and the throughput in MB/s.
+static bool h5_try_compression(hid_t type, void const* data, size_t size, H5_Compression const& compression,
+  double& ratio, double& throughput)
+{
+  hsize_t num_elements = size / H5Tget_size(type);
+  if (num_elements == 0) {
+    return false;
+  }
+
+  hid_t fapl_id = H5Pcreate(H5P_FILE_ACCESS);
+  H5Pset_fapl_core(fapl_id, 2 * size, false);
+  hid_t file_id = H5Fcreate("compression_trial.h5", H5F_ACC_TRUNC, H5P_DEFAULT, fapl_id);
+  H5Pclose(fapl_id);
+  if (file_id < 0) {
+    return false;
+  }
+
+  hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(plist_id, 1, &num_elements);
+  h5_add_filters(plist_id, type, compression);
+
+  Timer timer;
+  herr_t err = -1;
+  H5E_BEGIN_TRY {
+    hid_t dataspace_id = H5Screate_simple(1, &num_elements, NULL);
+    hid_t dataset_id = H5Dcreate2(file_id, "sample", type, dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+    if (dataset_id >= 0) {
+      err = H5Dwrite(dataset_id, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+      // the chunk is compressed when it is flushed from the chunk cache
+      H5Fflush(file_id, H5F_SCOPE_LOCAL);
+      hsize_t storage_size = H5Dget_storage_size(dataset_id);
+      ratio = storage_size > 0 ? (double)(num_elements * H5Tget_size(type)) / storage_size : 0.0;
+      H5Dclose(dataset_id);
+    }
+    H5Sclose(dataspace_id);
+  } H5E_END_TRY;
+  uint64_t time = std::max(timer.getTimeMicroseconds(), (uint64_t)1);
+  throughput = (double)size / time;
+
+  H5Pclose(plist_id);
+  H5Fclose(file_id);
+
+  return err >= 0;
+}
+
+// Add the filters of the current compression to `plist_id` of a dataset of type
+// `type` with the data `data` of `size` bytes. In automatic mode, the filter chain
+// with the best ratio at the required throughput is selected using a sample of the data.
+static void h5_set_filters(hid_t plist_id, hid_t type, void const* data, size_t size)
+{
+  if (!current_compression.automatic) {
+    h5_add_filters(plist_id, type, current_compression);
+    return;
+  }
+
+  vector<string> candidates = {"none", "deflate:1", "shuffle,deflate:1", "shuffle,deflate:6"};
+  if (H5Tget_class(type) == H5T_INTEGER) {
+    candidates.push_back("scaleoffset,deflate:1");
+  }
+  char const* plugins[] = {"lzf", "shuffle,lz4", "shuffle,zstd", "bitshuffle", "blosc"};
+  for (char const* plugin : plugins) {
+    H5_Compression compression;
+    if (h5_parse_compression(plugin, compression) && H5Zfilter_avail(compression.filters.back()) > 0) {
+      candidates.push_back(plugin);
+    }
+  }
+
+  // the fastest chain is used if no chain reaches the throughput; among chains
+  // with almost the best ratio, the fastest one is preferred
+  size_t sample_size = std::min(size, compression_sample_size);
+  vector<H5_Compression> compressions(candidates.size());
+  vector<double> ratios(candidates.size(), 0.0), throughputs(candidates.size(), 0.0);
+  size_t fastest = 0;
+  double best_ratio = 0.0;
+  for (size_t idx = 0; idx < candidates.size(); ++idx) {
+    h5_parse_compression(candidates.at(idx), compressions.at(idx));
+    if (!h5_try_compression(type, data, sample_size, compressions.at(idx), ratios.at(idx), throughputs.at(idx))) {
+      ratios.at(idx) = 0.0;
+      continue;
+    }
+    if (is_parallel_chain(compressions.at(idx).filters)) {
+      throughputs.at(idx) *= num_threads;
+    }
+    if (throughputs.at(idx) > throughputs.at(fastest)) {
+      fastest = idx;
+    }
+    if (throughputs.at(idx) >= current_compression.min_throughput) {
+      best_ratio = std::max(best_ratio, ratios.at(idx));
+    }
+  }
+
+  size_t selected = fastest;
+  for (size_t idx = 0; idx < candidates.size(); ++idx) {
+    if (throughputs.at(idx) >= current_compression.min_throughput && ratios.at(idx) >= 0.98 * best_ratio
+        && (ratios.at(selected) < 0.98 * best_ratio || throughputs.at(idx) > throughputs.at(selected))) {
+      selected = idx;
+    }
+  }
+
+  h5_add_filters(plist_id, type, compressions.at(selected));
+}
+
+
+// write a buffer to an HDF5 file using compression
+template<typename TYPE>
+bool h5_write_buffer(char const* filename, char const* varname, TYPE const* data, size_t size, std::string const& description)
+{
+  return h5_write_buffer<TYPE>(filename, varname, data, vector<size_t>(1, size), vector<size_t>(), description);
+}
+
+template<typename TYPE>
+bool h5_write_buffer(char const* filename, char const* varname, TYPE const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description)
+{
+  hid_t   h5_file_id, dataset_id, dataspace_id;
+  hid_t   plist_id;
+
+  if (!fileExists(filename)) {
+    h5_file_id = h5_create_file(filename);
+  }
+  else {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+
+  // the components of OpenCL vector types are stored as additional dimension
+  vector<hsize_t> hdf_dims(dims.begin(), dims.end());
+  if (get_vector_size<TYPE>() != 1) {
+    hdf_dims.push_back(get_vector_size<TYPE>());
+  }
+  int ndims = (int)hdf_dims.size();
+
+  // chunks used for compression; the chunks of the input dataset are kept if given
+  vector<hsize_t> hdf_chunk_dims = h5_chunk_dims(hdf_dims, sizeof(TYPE) / get_vector_size<TYPE>(),
+    chunk_dims.size() == dims.size() ? chunk_dims : vector<size_t>());
+
+  plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  // empty datasets cannot be chunked
+  if (std::find(hdf_dims.begin(), hdf_dims.end(), 0) == hdf_dims.end()) {
+    H5Pset_chunk(plist_id, ndims, &(hdf_chunk_dims[0]));
+    size_t num_elements = accumulate(hdf_dims.begin(), hdf_dims.end(), (size_t)1, std::multiplies<size_t>());
+    h5_set_filters(plist_id, type_to_h5_type<TYPE>(), data, num_elements * sizeof(TYPE) / get_vector_size<TYPE>());
+  }
+
+  dataspace_id = H5Screate_simple(ndims, &(hdf_dims[0]), NULL);
+  dataset_id = H5Dcreate2(h5_file_id, varname , type_to_h5_type<TYPE>(), dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+
+  if (!h5_write_chunks(dataset_id, data)) {
+    H5Dwrite(dataset_id, type_to_h5_type<TYPE>(), dataspace_id, dataspace_id, H5P_DEFAULT, data);
+  }
+  // The same can be done using H5 High Level API, but without compression
+  // H5LTmake_dataset(h5_file_id, varname, ndims, hdf_dims, type_to_h5_type<TYPE>(), data);
+
+  if (!description.empty()) {
+    H5LTset_attribute_string(h5_file_id, varname, "description", description.c_str());
+  }
+
+  H5Pclose(plist_id);
+  H5Dclose(dataset_id);
+  H5Sclose(dataspace_id);
+
+  h5_close_file(h5_file_id);
+
+  return true;
+}
+
+// template instantiations
+template bool h5_write_buffer(char const* filename, char const* varname, float const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, double const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_char const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_uchar const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_short const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_ushort const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_int const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_uint const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_long const* data, size_t size, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_ulong const* data, size_t size, std::string const& description);
+
+template bool h5_write_buffer(char const* filename, char const* varname, float const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, double const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_char const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_uchar const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_short const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_ushort const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_int const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_uint const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_long const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+template bool h5_write_buffer(char const* filename, char const* varname, cl_ulong const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, std::string const& description);
+
+
+
+
+// create a dataset without writing any data
+template<typename TYPE>
+bool h5_create_buffer(char const* filename, char const* varname, size_t size, TYPE fill_value, std::string const& description)
+{
+  hid_t h5_file_id;
+
+  if (!fileExists(filename)) {
+    h5_file_id = h5_create_file(filename);
+  }
+  else {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+
+  hsize_t hdf_dims[1] = { size };
+
+  // a contiguous dataset does not allocate any storage until data is written
+  hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_fill_value(plist_id, type_to_h5_type<TYPE>(), &fill_value);
+
+  hid_t dataspace_id = H5Screate_simple(1, hdf_dims, NULL);
+  hid_t dataset_id = H5Dcreate2(h5_file_id, varname, type_to_h5_type<TYPE>(), dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+
+  if (!description.empty()) {
+    H5LTset_attribute_string(h5_file_id, varname, "description", description.c_str());
+  }
+
+  H5Pclose(plist_id);
+  H5Dclose(dataset_id);
+  H5Sclose(dataspace_id);
+
+  h5_close_file(h5_file_id);
+
+  return dataset_id >= 0;
+}
+
+// template instantiations
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, float fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, double fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, cl_char fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, cl_uchar fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, cl_short fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, cl_ushort fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, cl_int fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, cl_uint fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, cl_long fill_value, std::string const& description);
+template bool h5_create_buffer(char const* filename, char const* varname, size_t size, cl_ulong fill_value, std::string const& description);
+
+
+bool h5_check_fill_value(char const* filename, char const* varname)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  if (H5Aexists_by_name(h5_file_id, varname, "fill_value", H5P_DEFAULT) > 0) {
+    h5_close_file(h5_file_id);
+    return true;
+  }
+
+  hid_t dataset = H5Dopen(h5_file_id, varname, H5P_DEFAULT);
+  H5D_space_status_t status;
+  H5Dget_space_status(dataset, &status);
+
+  hid_t plist_id = H5Dget_create_plist(dataset);
+  H5D_fill_value_t fill_status;
+  H5Pfill_value_defined(plist_id, &fill_status);
+
+  bool found = (status == H5D_SPACE_STATUS_NOT_ALLOCATED) && (fill_status != H5D_FILL_VALUE_UNDEFINED);
+
+  H5Pclose(plist_id);
+  H5Dclose(dataset);
+  h5_close_file(h5_file_id);
+
+  return found;
+}
+
+bool h5_read_fill_value(char const* filename, char const* varname, HD5_Type type, void* value)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
+    std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  // the attribute `fill_value` takes precedence over the fill value of the dataset
+  herr_t err;
+  if (H5Aexists_by_name(h5_file_id, varname, "fill_value", H5P_DEFAULT) > 0) {
+    hid_t attr = H5Aopen_by_name(h5_file_id, varname, "fill_value", H5P_DEFAULT, H5P_DEFAULT);
+    hid_t attr_space = H5Aget_space(attr);
+    if (H5Sget_simple_extent_npoints(attr_space) == 1) {
+      err = H5Aread(attr, type_to_h5_type(type), value);
+    }
+    else {
+      err = -1;
+    }
+    H5Sclose(attr_space);
+    H5Aclose(attr);
+  }
+  else {
+    hid_t dataset = H5Dopen(h5_file_id, varname, H5P_DEFAULT);
+    hid_t plist_id = H5Dget_create_plist(dataset);
+    err = H5Pget_fill_value(plist_id, type_to_h5_type(type), value);
+    H5Pclose(plist_id);
+    H5Dclose(dataset);
+  }
+
+  h5_close_file(h5_file_id);
+
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Reading fill value of '" << varname << "' in file '" << filename << "' not possible." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+bool h5_get_dims(char const* filename, char const* varname, std::vector<size_t>& dims)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
+    std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  hid_t dataset = H5Dopen(h5_file_id, varname, H5P_DEFAULT);
+  hid_t dataspace = H5Dget_space(dataset);
+  int ndims = H5Sget_simple_extent_ndims(dataspace);
+  vector<hsize_t> hdf_dims(std::max(ndims, 1), 1);
+  H5Sget_simple_extent_dims(dataspace, &(hdf_dims[0]), NULL);
+  H5Sclose(dataspace);
+  H5Dclose(dataset);
+  h5_close_file(h5_file_id);
+
+  dims.assign(hdf_dims.begin(), hdf_dims.end());
+  return true;
+}
+
+
+bool h5_get_chunk_dims(char const* filename, char const* varname, std::vector<size_t>& chunk_dims)
+{
+  chunk_dims.clear();
+
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
+    std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  hid_t dataset = H5Dopen(h5_file_id, varname, H5P_DEFAULT);
+  hid_t plist_id = H5Dget_create_plist(dataset);
+  if (H5Pget_layout(plist_id) == H5D_CHUNKED) {
+    int ndims = H5Pget_chunk(plist_id, 0, NULL);
+    vector<hsize_t> hdf_chunk_dims(std::max(ndims, 1), 1);
+    H5Pget_chunk(plist_id, ndims, &(hdf_chunk_dims[0]));
+    chunk_dims.assign(hdf_chunk_dims.begin(), hdf_chunk_dims.begin() + ndims);
+  }
+  H5Pclose(plist_id);
+  H5Dclose(dataset);
+  h5_close_file(h5_file_id);
+
+  return true;
+}
+
+
+bool h5_get_raw_data_offset(char const* filename, char const* varname, std::string& data_filename, size_t& offset, size_t& size)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
+    std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  // external links are followed to the file containing the data. Only the data
+  // of the default file driver are stored as plain bytes in the file.
+  hid_t dataset = H5Dopen(h5_file_id, varname, H5P_DEFAULT);
+  hid_t data_file_id = H5Iget_file_id(dataset);
+  ssize_t len = H5Fget_name(data_file_id, NULL, 0);
+  std::vector<char> name(len + 1, '\0');
+  H5Fget_name(data_file_id, &(name[0]), len + 1);
+  data_filename = &(name[0]);
+  hid_t fapl_id = H5Fget_access_plist(data_file_id);
+  bool plain_file = H5Pget_driver(fapl_id) == H5FD_SEC2;
+  H5Pclose(fapl_id);
+  H5Fclose(data_file_id);
+
+  hid_t plist_id = H5Dget_create_plist(dataset);
+  hid_t datatype = H5Dget_type(dataset);
+  hid_t native_type = h5_native_type(datatype);
+
+  bool contiguous = plain_file && H5Pget_layout(plist_id) == H5D_CONTIGUOUS
+                 && H5Pget_nfilters(plist_id) == 0 && H5Pget_external_count(plist_id) == 0
+                 && H5Tequal(datatype, native_type) > 0;
+  haddr_t address = contiguous ? H5Dget_offset(dataset) : HADDR_UNDEF;
+  if (address != HADDR_UNDEF) {
+    offset = (size_t)address;
+    size = (size_t)H5Dget_storage_size(dataset);
+  }
+
+  H5Tclose(native_type);
+  H5Tclose(datatype);
+  H5Pclose(plist_id);
+  H5Dclose(dataset);
+  h5_close_file(h5_file_id);
+
+  return address != HADDR_UNDEF;
+}
+
+
+// hash the encoded description of a datatype
+static uint64_t h5_hash_type(hid_t datatype, uint64_t hash)
+{
+  size_t size = 0;
+  H5Tencode(datatype, NULL, &size);
+  vector<uint8_t> buffer(size + 1);
+  H5Tencode(datatype, &(buffer[0]), &size);
+  return hash_bytes(&(buffer[0]), size, hash);
+}
+
+// hash blocks of bytes on up to `num_threads` threads and combine the hashes in order
+static uint64_t hash_blocks(vector<std::pair<uint8_t const*, size_t>> const& blocks, uint64_t hash)
+{
+  vector<uint64_t> hashes(blocks.size());
+  std::atomic<size_t> next_block(0);
+  auto hash_next_blocks = [&]() {
+    for (size_t block = next_block++; block < blocks.size(); block = next_block++) {
+      hashes[block] = hash_bytes(blocks[block].first, blocks[block].second);
+    }
+  };
+
+  vector<std::thread> threads;
+  for (size_t thread = 1; thread < std::min<size_t>(num_threads, blocks.size()); ++thread) {
+    threads.emplace_back(hash_next_blocks);
+  }
+  hash_next_blocks();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (uint64_t block_hash : hashes) {
+    hash = hash_combine(hash, block_hash);
+  }
+  return hash;
+}
+
+// hash the names, types and values of the attributes of an object; false for
+// variable length data other than strings
+static bool h5_hash_attributes(hid_t object, uint64_t& hash)
+{
+  H5O_info_t info;
+#if H5_VERSION_GE(1,10,3)
+  H5Oget_info2(object, &info, H5O_INFO_NUM_ATTRS);
+#else
+  H5Oget_info(object, &info);
+#endif
+
+  bool success = true;
+  for (hsize_t idx = 0; success && idx < info.num_attrs; idx++) {
+    hid_t attribute = H5Aopen_by_idx(object, ".", H5_INDEX_NAME, H5_ITER_INC, idx, H5P_DEFAULT, H5P_DEFAULT);
+    ssize_t len = H5Aget_name(attribute, 0, NULL);
+    vector<char> name(len + 1, '\0');
+    H5Aget_name(attribute, len + 1, &(name[0]));
+    hid_t datatype = H5Aget_type(attribute);
+    hid_t dataspace = H5Aget_space(attribute);
+    size_t num_elements = std::max<hssize_t>(H5Sget_simple_extent_npoints(dataspace), 1);
+
+    hash = hash_combine(hash, std::string(&(name[0])));
+    hash = h5_hash_type(datatype, hash);
+    if (H5Tis_variable_str(datatype) > 0) {
+      vector<char*> strings(num_elements, nullptr);
+      H5Aread(attribute, datatype, &(strings[0]));
+      for (char const* string : strings) {
+        hash = hash_combine(hash, std::string(string != nullptr ? string : ""));
+      }
+      H5Dvlen_reclaim(datatype, dataspace, H5P_DEFAULT, &(strings[0]));
+    }
+    else if (H5Tdetect_class(datatype, H5T_VLEN) > 0) {
+      success = false;
+    }
+    else {
+      vector<uint8_t> data(num_elements * H5Tget_size(datatype));
+      H5Aread(attribute, datatype, &(data[0]));
+      hash = hash_bytes(&(data[0]), data.size(), hash);
+    }
+
+    H5Sclose(dataspace);
+    H5Tclose(datatype);
+    H5Aclose(attribute);
+  }
+  return success;
+}
+
+// Hash the type, shape, fill value and stored data of a dataset. The raw chunks of
+// chunked datasets are hashed without decompressing them; if the chunks carry
+// Fletcher-32 checksums, only these are read from the file.
+static bool h5_hash_data(hid_t dataset, uint64_t& hash)
+{
+  hid_t datatype = H5Dget_type(dataset);
+  hid_t dataspace = H5Dget_space(dataset);
+  hid_t plist_id = H5Dget_create_plist(dataset);
+
+  int ndims = H5Sget_simple_extent_ndims(dataspace);
+  vector<hsize_t> dims(std::max(ndims, 1), 1);
+  H5Sget_simple_extent_dims(dataspace, &(dims[0]), NULL);
+  hash = h5_hash_type(datatype, hash);
+  hash = hash_bytes(&(dims[0]), dims.size() * sizeof(hsize_t), hash);
+
+  size_t const type_size = H5Tget_size(datatype);
+  H5D_fill_value_t fill_status;
+  H5Pfill_value_defined(plist_id, &fill_status);
+  if (fill_status == H5D_FILL_VALUE_USER_DEFINED) {
+    vector<uint8_t> fill_value(type_size);
+    H5Pget_fill_value(plist_id, datatype, &(fill_value[0]));
+    hash = hash_bytes(&(fill_value[0]), type_size, hash);
+  }
+
+  // the checksum of the last filter is stored in the last four bytes of a chunk
+  int const num_filters = H5Pget_nfilters(plist_id);
+  bool checksums = false;
+  for (int idx = 0; idx < num_filters; ++idx) {
+    unsigned int flags, cd_values[8];
+    size_t cd_nelmts = 8;
+    H5Z_filter_t filter = H5Pget_filter2(plist_id, idx, &flags, &cd_nelmts, cd_values, 0, NULL, NULL);
+    hash = hash_combine(hash, (uint64_t)filter);
+    checksums = filter == H5Z_FILTER_FLETCHER32 && idx + 1 == num_filters;
+  }
+
+  hssize_t const num_elements = H5Sget_simple_extent_npoints(dataspace);
+  bool success = true;
+  bool hashed = false;
+  if (H5Tis_variable_str(datatype) > 0) {
+    vector<char*> strings(std::max<hssize_t>(num_elements, 1), nullptr);
+    H5Dread(dataset, datatype, H5S_ALL, H5S_ALL, H5P_DEFAULT, &(strings[0]));
+    for (char const* string : strings) {
+      hash = hash_combine(hash, std::string(string != nullptr ? string : ""));
+    }
+    H5Dvlen_reclaim(datatype, dataspace, H5P_DEFAULT, &(strings[0]));
+    hashed = true;
+  }
+  else if (H5Tdetect_class(datatype, H5T_VLEN) > 0) {
+    success = false;
+    hashed = true;
+  }
+#if H5_VERSION_GE(1, 10, 5)
+  else if (H5Pget_layout(plist_id) == H5D_CHUNKED) {
+    hsize_t num_chunks = 0;
+    H5Dget_num_chunks(dataset, dataspace, &num_chunks);
+    hash = hash_combine(hash, (uint64_t)num_chunks);
+
+    // the checksums are read directly from files of the default driver
+    hid_t file_id = H5Iget_file_id(dataset);
+    hid_t fapl_id = H5Fget_access_plist(file_id);
+    std::ifstream file;
+    if (checksums && H5Pget_driver(fapl_id) == H5FD_SEC2) {
+      ssize_t len = H5Fget_name(file_id, NULL, 0);
+      vector<char> name(len + 1, '\0');
+      H5Fget_name(file_id, &(name[0]), len + 1);
+      file.open(&(name[0]), std::ios::binary);
+    }
+    H5Pclose(fapl_id);
+    H5Fclose(file_id);
+
+    // the raw chunks are read in batches by this thread and hashed on all threads
+    size_t const batch_size = 4 * (size_t)num_threads;
+    vector<vector<uint8_t>> chunks;
+    auto hash_chunks = [&]() {
+      vector<std::pair<uint8_t const*, size_t>> blocks;
+      for (vector<uint8_t> const& chunk : chunks) {
+        blocks.emplace_back(chunk.data(), chunk.size());
+      }
+      hash = hash_blocks(blocks, hash);
+      chunks.clear();
+    };
+    vector<hsize_t> offset(dims.size());
+    for (hsize_t idx = 0; success && idx < num_chunks; ++idx) {
+      unsigned int mask = 0;
+      haddr_t address = HADDR_UNDEF;
+      hsize_t size = 0;
+      success = H5Dget_chunk_info(dataset, dataspace, idx, &(offset[0]), &mask, &address, &size) >= 0;
+      hash = hash_bytes(&(offset[0]), offset.size() * sizeof(hsize_t), hash);
+      hash = hash_combine(hash_combine(hash, (uint64_t)mask), (uint64_t)size);
+
+      if (file.is_open() && (mask & (1u << (num_filters - 1))) == 0 && size >= 4) {
+        uint32_t checksum = 0;
+        file.seekg(address + size - 4);
+        file.read((char*)&checksum, 4);
+        success = success && file.good();
+        hash = hash_combine(hash, (uint64_t)checksum);
+        continue;
+      }
+
+      chunks.emplace_back(size + 1);
+      uint32_t filter_mask = 0;
+      success = success && H5Dread_chunk(dataset, H5P_DEFAULT, &(offset[0]), &filter_mask, &(chunks.back()[0])) >= 0;
+      chunks.back().pop_back();
+      if (chunks.size() == batch_size) {
+        hash_chunks();
+      }
+    }
+    hash_chunks();
+    hashed = true;
+  }
+#endif
+  if (!hashed) {
+    // the data are read without conversion and hashed in blocks of 4 MiB
+    vector<uint8_t> data(std::max<hssize_t>(num_elements, 1) * type_size);
+    success = H5Dread(dataset, datatype, H5S_ALL, H5S_ALL, H5P_DEFAULT, &(data[0])) >= 0;
+    size_t const block_size = 1 << 22;
+    vector<std::pair<uint8_t const*, size_t>> blocks;
+    for (size_t pos = 0; pos < data.size(); pos += block_size) {
+      blocks.emplace_back(&(data[pos]), std::min(block_size, data.size() - pos));
+    }
+    hash = hash_blocks(blocks, hash);
+  }
+
+  H5Pclose(plist_id);
+  H5Sclose(dataspace);
+  H5Tclose(datatype);
+  return success;
+}
+
+static bool h5_hash_object(hid_t loc_id, std::string const& name, uint64_t& hash)
+{
+  hid_t object = H5Oopen(loc_id, name.c_str(), H5P_DEFAULT);
+  if (object < 0) {
+    return false;
+  }
+
+  hash = hash_combine(hash, name);
+  bool success = h5_hash_attributes(object, hash);
+  switch (H5Iget_type(object)) {
+    case H5I_GROUP:
+      for (std::string const& member : h5_get_members(object, ".")) {
+        success = success && h5_hash_object(object, member, hash);
+      }
+      break;
+    case H5I_DATASET: {
+      // opened again to find external storage files next to the HDF5 file
+      hid_t dapl_id = h5_dataset_access();
+      hid_t dataset = H5Dopen(loc_id, name.c_str(), dapl_id);
+      H5Pclose(dapl_id);
+      success = success && dataset >= 0 && h5_hash_data(dataset, hash);
+      if (dataset >= 0) {
+        H5Dclose(dataset);
+      }
+      break;
+    }
+    case H5I_DATATYPE:
+      hash = h5_hash_type(object, hash);
+      break;
+    default:
+      break;
+  }
+
+  H5Oclose(object);
+  return success;
+}
+
+bool h5_hash_object(char const* filename, char const* name, uint64_t& hash)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, name, true) <= 0) {
+    std::cerr << ERROR_INFO << "Object '" << name << "' not found in file '" << filename << "'." << std::endl;
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  bool success = h5_hash_object(h5_file_id, name, hash);
+  h5_close_file(h5_file_id);
+
+  return success;
+}
+
+
+bool h5_check_selection(char const* filename, char const* varname)
+{
+  return h5_check_attribute(filename, varname, "output_offset")
+      || h5_check_attribute(filename, varname, "output_count")
+      || h5_check_attribute(filename, varname, "output_stride");
+}
+
+// read an integer attribute with one entry per dimension of the dataset, if present
+static bool h5_read_selection_attribute(hid_t h5_file_id, char const* varname, char const* attr_name, std::vector<size_t>& values)
+{
+  if (H5Aexists_by_name(h5_file_id, varname, attr_name, H5P_DEFAULT) <= 0) {
+    return true;
+  }
+
+  hid_t attr = H5Aopen_by_name(h5_file_id, varname, attr_name, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t attr_space = H5Aget_space(attr);
+
+  herr_t err = -1;
+  vector<hsize_t> buffer(H5Sget_simple_extent_npoints(attr_space));
+  if (buffer.size() == values.size()) {
+    err = H5Aread(attr, H5T_NATIVE_HSIZE, &(buffer[0]));
+    values.assign(buffer.begin(), buffer.end());
+  }
+
+  H5Sclose(attr_space);
+  H5Aclose(attr);
+
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Attribute '" << attr_name << "' of '" << varname << "' needs one integer per dimension." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool h5_read_selection(char const* filename, char const* varname, H5_Selection& selection)
+{
+  if (!h5_get_dims(filename, varname, selection.dims)) {
+    return false;
+  }
+
+  size_t const rank = selection.dims.size();
+  if (rank > 3) {
+    std::cerr << ERROR_INFO << "Output selections of '" << varname << "' are limited to three dimensions." << std::endl;
+    return false;
+  }
+
+  selection.offset.assign(rank, 0);
+  selection.stride.assign(rank, 1);
+  selection.count.assign(rank, 0);
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+
+  bool has_count = H5Aexists_by_name(h5_file_id, varname, "output_count", H5P_DEFAULT) > 0;
+  bool success = h5_read_selection_attribute(h5_file_id, varname, "output_offset", selection.offset)
+              && h5_read_selection_attribute(h5_file_id, varname, "output_stride", selection.stride)
+              && h5_read_selection_attribute(h5_file_id, varname, "output_count", selection.count);
+
+  h5_close_file(h5_file_id);
+
+  if (!success) {
+    return false;
+  }
+
+  for (size_t dim = 0; dim < rank; ++dim) {
+    if (selection.stride.at(dim) == 0 || selection.offset.at(dim) > selection.dims.at(dim)) {
+      std::cerr << ERROR_INFO << "Output selection of '" << varname << "' is not valid." << std::endl;
+      return false;
+    }
+
+    size_t const remaining = selection.dims.at(dim) - selection.offset.at(dim);
+    size_t const max_count = (remaining + selection.stride.at(dim) - 1) / selection.stride.at(dim);
+    if (!has_count) {
+      selection.count.at(dim) = max_count;
+    }
+    else if (selection.count.at(dim) > max_count) {
+      std::cerr << ERROR_INFO << "Output selection of '" << varname << "' exceeds the dataset." << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+bool h5_write_selection(char const* filename, char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& mem_dims, std::vector<size_t> const& stride, std::vector<size_t> const& count,
+  std::vector<size_t> const& chunk_dims, std::string const& description)
+{
+  hid_t h5_file_id;
+
+  if (!fileExists(filename)) {
+    h5_file_id = h5_create_file(filename);
+  }
+  else {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+
+  int ndims = (int)count.size();
+  vector<hsize_t> hdf_mem_dims(mem_dims.begin(), mem_dims.end());
+  vector<hsize_t> hdf_stride(stride.begin(), stride.end());
+  vector<hsize_t> hdf_count(count.begin(), count.end());
+  vector<hsize_t> hdf_start(ndims, 0);
+
+  // the selected elements of the dense block are gathered by the HDF5 library
+  hid_t memspace_id = H5Screate_simple(ndims, &(hdf_mem_dims[0]), NULL);
+  H5Sselect_hyperslab(memspace_id, H5S_SELECT_SET, &(hdf_start[0]), &(hdf_stride[0]), &(hdf_count[0]), NULL);
+
+  vector<hsize_t> hdf_chunk_dims = h5_chunk_dims(hdf_count, get_type_size(type),
+    chunk_dims.size() == count.size() ? chunk_dims : vector<size_t>());
+
+  hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(plist_id, ndims, &(hdf_chunk_dims[0]));
+  size_t num_box = accumulate(hdf_mem_dims.begin(), hdf_mem_dims.end(), (size_t)1, std::multiplies<size_t>());
+  h5_set_filters(plist_id, type_to_h5_type(type), data, num_box * get_type_size(type));
+
+  hid_t dataspace_id = H5Screate_simple(ndims, &(hdf_count[0]), NULL);
+  hid_t dataset_id = H5Dcreate2(h5_file_id, varname, type_to_h5_type(type), dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+
+  herr_t err = H5Dwrite(dataset_id, type_to_h5_type(type), memspace_id, dataspace_id, H5P_DEFAULT, data);
+
+  if (!description.empty()) {
+    H5LTset_attribute_string(h5_file_id, varname, "description", description.c_str());
+  }
+
+  H5Pclose(plist_id);
+  H5Dclose(dataset_id);
+  H5Sclose(dataspace_id);
+  H5Sclose(memspace_id);
+
+  h5_close_file(h5_file_id);
+
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Writing variable '" << varname << "' to file '" << filename << "' not possible." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+// lane counts of OpenCL vector types
+static bool is_vector_lanes(size_t lanes)
+{
+  return lanes == 2 || lanes == 3 || lanes == 4 || lanes == 8 || lanes == 16;
+}
+
+// Create the memory type of `file_type` using the size and alignment of the
+// corresponding OpenCL C type. Returns a negative value for unsupported types.
+static hid_t h5_device_type(hid_t file_type, size_t& size, size_t& alignment)
+{
+  switch (H5Tget_class(file_type)) {
+    case H5T_INTEGER:
+    case H5T_FLOAT: {
+      hid_t mem_type = h5_native_type(file_type);
+      size = H5Tget_size(mem_type);
+      alignment = size;
+      return mem_type;
+    }
+
+    case H5T_ARRAY: {
+      int ndims = H5Tget_array_ndims(file_type);
+      vector<hsize_t> dims(ndims);
+      H5Tget_array_dims2(file_type, &(dims[0]));
+      hsize_t num = accumulate(dims.begin(), dims.end(), (hsize_t)1, std::multiplies<hsize_t>());
+
+      hid_t super_type = H5Tget_super(file_type);
+      size_t base_size, base_alignment;
+      hid_t base_type = h5_device_type(super_type, base_size, base_alignment);
+      H5Tclose(super_type);
+      if (base_type < 0) {
+        return base_type;
+      }
+
+      hid_t mem_type = H5Tarray_create2(base_type, ndims, &(dims[0]));
+      if (ndims == 1 && is_vector_lanes(num) && H5Tget_class(base_type) != H5T_COMPOUND) {
+        // vectors are aligned to their size; three lanes occupy the space of four
+        size = base_size * (num == 3 ? 4 : num);
+        alignment = size;
+      }
+      else {
+        size = base_size * num;
+        alignment = base_alignment;
+      }
+      H5Tclose(base_type);
+      return mem_type;
+    }
+
+    case H5T_COMPOUND: {
+      int nmembers = H5Tget_nmembers(file_type);
+      vector<hid_t> member_types(nmembers);
+      vector<size_t> offsets(nmembers);
+
+      size_t offset = 0;
+      alignment = 1;
+      for (int member = 0; member < nmembers; ++member) {
+        hid_t member_file_type = H5Tget_member_type(file_type, member);
+        size_t member_size, member_alignment;
+        member_types.at(member) = h5_device_type(member_file_type, member_size, member_alignment);
+        H5Tclose(member_file_type);
+        if (member_types.at(member) < 0) {
+          for (int prev = 0; prev < member; ++prev) {
+            H5Tclose(member_types.at(prev));
+          }
+          return -1;
+        }
+
+        offset = ((offset + member_alignment - 1) / member_alignment) * member_alignment;
+        offsets.at(member) = offset;
+        offset += member_size;
+        alignment = std::max(alignment, member_alignment);
+      }
+      size = ((std::max(offset, (size_t)1) + alignment - 1) / alignment) * alignment;
+
+      hid_t mem_type = H5Tcreate(H5T_COMPOUND, size);
+      for (int member = 0; member < nmembers; ++member) {
+        char* name = H5Tget_member_name(file_type, member);
+        H5Tinsert(mem_type, name, offsets.at(member), member_types.at(member));
+        H5free_memory(name);
+        H5Tclose(member_types.at(member));
+      }
+      return mem_type;
+    }
+
+    default:
+      return -1;
+  }
+}
+
+
+bool h5_get_device_layout(char const* filename, char const* varname, size_t lanes, H5_Device_Layout& layout)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
+    std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  hid_t dataset = H5Dopen(h5_file_id, varname, H5P_DEFAULT);
+  hid_t dataspace = H5Dget_space(dataset);
+  hid_t datatype = H5Dget_type(dataset);
+
+  int ndims = H5Sget_simple_extent_ndims(dataspace);
+  vector<hsize_t> dims(std::max(ndims, 1), 1);
+  H5Sget_simple_extent_dims(dataspace, &(dims[0]), NULL);
+
+  layout.num_elements = H5Sget_simple_extent_npoints(dataspace);
+  layout.lanes = 1;
+  layout.mem_type.clear();
+
+  bool success = true;
+  H5T_class_t type_class = H5Tget_class(datatype);
+  if (type_class == H5T_ARRAY || type_class == H5T_COMPOUND) {
+    size_t alignment;
+    hid_t mem_type = h5_device_type(datatype, layout.element_size, alignment);
+    if (mem_type < 0) {
+      std::cerr << ERROR_INFO << "Data type of '" << varname << "' is not supported on the device." << std::endl;
+      success = false;
+    }
+    else {
+      if (type_class == H5T_ARRAY && H5Tget_array_ndims(datatype) == 1) {
+        hsize_t num;
+        H5Tget_array_dims2(datatype, &num);
+        if (is_vector_lanes(num)) {
+          layout.lanes = num;
+        }
+      }
+
+      size_t nalloc = 0;
+      H5Tencode(mem_type, NULL, &nalloc);
+      layout.mem_type.resize(nalloc);
+      H5Tencode(mem_type, &(layout.mem_type[0]), &nalloc);
+      H5Tclose(mem_type);
+    }
+  }
+  else {
+    layout.element_size = H5Tget_size(datatype);
+    if (lanes > 1 && is_vector_lanes(lanes) && dims.back() == lanes) {
+      layout.lanes = lanes;
+      layout.num_elements /= lanes;
+      layout.element_size *= (lanes == 3 ? 4 : lanes);
+    }
+  }
+
+  H5Tclose(datatype);
+  H5Sclose(dataspace);
+  H5Dclose(dataset);
+  h5_close_file(h5_file_id);
+
+  return success;
+}
+
+
+bool h5_read_device_buffer(char const* filename, char const* varname, H5_Device_Layout const& layout, void* data)
+{
+  if (!fileExists(filename)) {
+    std::cerr << ERROR_INFO << "File '" << filename << "' not found." << std::endl;
+    return false;
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
+    std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
+    h5_close_file(h5_file_id);
+    return false;
+  }
+
+  hid_t dataset = h5_open_dataset(h5_file_id, varname);
+  hid_t mem_type;
+  if (layout.mem_type.empty()) {
+    hid_t datatype = H5Dget_type(dataset);
+    mem_type = h5_native_type(datatype);
+    H5Tclose(datatype);
+  }
+  else {
+    mem_type = H5Tdecode(&(layout.mem_type[0]));
+  }
+
+  hid_t datatype = H5Dget_type(dataset);
+  herr_t err = 0;
+  if (H5Tequal(datatype, mem_type) <= 0 || !h5_read_chunks(dataset, data)) {
+    err = H5Dread(dataset, mem_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+  }
+  H5Tclose(datatype);
+
+  // pad vectors of three lanes to four lanes, starting at the end
+  if (err >= 0 && layout.lanes == 3) {
+    size_t lane_size = layout.element_size / 4;
+    uint8_t* bytes = (uint8_t*)data;
+    for (size_t idx = layout.num_elements; idx-- > 0; ) {
+      memmove(bytes + idx * 4 * lane_size, bytes + idx * 3 * lane_size, 3 * lane_size);
+      memset(bytes + (idx * 4 + 3) * lane_size, 0, lane_size);
+    }
+  }
+
+  H5Tclose(mem_type);
+  H5Dclose(dataset);
+  h5_close_file(h5_file_id);
+
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Reading variable '" << varname << "' in file '" << filename << "' not possible." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+bool h5_write_device_buffer(char const* filename, char const* varname, H5_Device_Layout const& layout, HD5_Type type,
+  void const* data, std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims)
+{
+  hid_t h5_file_id;
+
+  if (!fileExists(filename)) {
+    h5_file_id = h5_create_file(filename);
+  }
+  else {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+
+  // compound types are stored without the padding used on the device
+  hid_t mem_type, file_type;
+  vector<hsize_t> hdf_dims(dims.begin(), dims.end());
+  if (layout.mem_type.empty()) {
+    mem_type = H5Tcopy(type_to_h5_type(type));
+    file_type = H5Tcopy(mem_type);
+  }
+  else {
+    mem_type = H5Tdecode(&(layout.mem_type[0]));
+    file_type = H5Tcopy(mem_type);
+    if (H5Tget_class(mem_type) == H5T_ARRAY) {
+      hdf_dims.resize(hdf_dims.size() - H5Tget_array_ndims(mem_type));
+    }
+    if (H5Tget_class(file_type) == H5T_COMPOUND) {
+      H5Tpack(file_type);
+    }
+  }
+  if (hdf_dims.empty()) {
+    hdf_dims.push_back(1);
+  }
+  int ndims = (int)hdf_dims.size();
+
+  // remove the padding of vectors of three lanes
+  void const* write_data = data;
+  vector<uint8_t> packed_data;
+  if (layout.lanes == 3) {
+    size_t lane_size = layout.element_size / 4;
+    packed_data.resize(layout.num_elements * 3 * lane_size);
+    for (size_t idx = 0; idx < layout.num_elements; ++idx) {
+      memcpy(&(packed_data[idx * 3 * lane_size]), (uint8_t const*)data + idx * 4 * lane_size, 3 * lane_size);
+    }
+    write_data = packed_data.data();
+  }
+
+  vector<hsize_t> hdf_chunk_dims = h5_chunk_dims(hdf_dims, H5Tget_size(file_type),
+    chunk_dims.size() == hdf_dims.size() ? chunk_dims : vector<size_t>());
+
+  hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  if (std::find(hdf_dims.begin(), hdf_dims.end(), 0) == hdf_dims.end()) {
+    H5Pset_chunk(plist_id, ndims, &(hdf_chunk_dims[0]));
+    size_t num_elements = accumulate(hdf_dims.begin(), hdf_dims.end(), (size_t)1, std::multiplies<size_t>());
+    h5_set_filters(plist_id, mem_type, write_data, num_elements * H5Tget_size(mem_type));
+  }
+
+  hid_t dataspace_id = H5Screate_simple(ndims, &(hdf_dims[0]), NULL);
+  hid_t dataset_id = H5Dcreate2(h5_file_id, varname, file_type, dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+
+  herr_t err = 0;
+  if (H5Tequal(mem_type, file_type) <= 0 || !h5_write_chunks(dataset_id, write_data)) {
+    err = H5Dwrite(dataset_id, mem_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, write_data);
+  }
+
+  H5Pclose(plist_id);
+  H5Dclose(dataset_id);
+  H5Sclose(dataspace_id);
+  H5Tclose(file_type);
+  H5Tclose(mem_type);
+
+  h5_close_file(h5_file_id);
+
+  if (err < 0) {
+    std::cerr << ERROR_INFO << "Writing variable '" << varname << "' to file '" << filename << "' not possible." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+void h5_sidecar_name(char const* filename, char const* varname, std::string& directory, std::string& name)
+{
+  string path(filename);
+  size_t separator = path.find_last_of("/\\");
+  directory = (separator == string::npos) ? "" : path.substr(0, separator + 1);
+  name = path.substr(directory.size());
+  if (name.size() > 3 && name.compare(name.size() - 3, 3, ".h5") == 0) {
+    name.resize(name.size() - 3);
+  }
+
+  string dataset_name(varname);
+  dataset_name.erase(0, dataset_name.find_first_not_of('/'));
+  std::replace(dataset_name.begin(), dataset_name.end(), '/', '_');
+  name += "." + dataset_name;
+}
+
+
+bool h5_write_shards(char const* filename, char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims, size_t shard_size)
+{
+  if (dims.empty()) {
+    std::cerr << ERROR_INFO << "Variable '" << varname << "' without dimensions cannot be split into shards." << std::endl;
+    return false;
+  }
+
+  size_t type_size = get_type_size(type);
+  size_t row_elements = accumulate(dims.begin() + 1, dims.end(), (size_t)1, std::multiplies<size_t>());
+  size_t row_bytes = row_elements * type_size;
+  size_t rows_per_shard = std::max((size_t)1, shard_size / std::max(row_bytes, (size_t)1));
+  size_t num_shards = (dims[0] + rows_per_shard - 1) / rows_per_shard;
+
+  string directory, stem;
+  h5_sidecar_name(filename, varname, directory, stem);
+  vector<string> shard_names(num_shards);
+  for (size_t shard = 0; shard < num_shards; ++shard) {
+    shard_names.at(shard) = stem + "." + std::to_string(shard) + ".h5";
+  }
+
+  auto write_shard = [&](size_t shard) {
+    size_t first_row = shard * rows_per_shard;
+    vector<size_t> shard_dims(dims);
+    shard_dims[0] = std::min(rows_per_shard, dims[0] - first_row);
+    string shard_file = directory + shard_names.at(shard);
+    remove(shard_file.c_str());
+    return h5_write_device_buffer(shard_file.c_str(), "data", H5_Device_Layout{shard_dims[0] * row_elements, 1, type_size, {}}, type,
+                                  (uint8_t const*)data + first_row * row_bytes, shard_dims, chunk_dims);
+  };
+
+  // The HDF5 library serializes all calls, so the shards are written one after
+  // the other, each compressed on `h5_get_threads()` threads by `h5_write_chunks`.
+  bool success = true;
+  for (size_t shard = 0; shard < num_shards; ++shard) {
+    success = write_shard(shard) && success;
+  }
+  if (!success) {
+    std::cerr << ERROR_INFO << "Writing the shards of variable '" << varname << "' not possible." << std::endl;
+    return false;
+  }
+
+  // virtual dataset mapping the slices of the dataset to the shards
+  hid_t h5_file_id;
+  if (!fileExists(filename)) {
+    h5_file_id = h5_create_file(filename);
+  }
+  else {
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
+  }
+
+  int ndims = (int)dims.size();
+  vector<hsize_t> hdf_dims(dims.begin(), dims.end());
+  hid_t dataspace_id = H5Screate_simple(ndims, &(hdf_dims[0]), NULL);
+  hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  for (size_t shard = 0; shard < num_shards; ++shard) {
+    vector<hsize_t> start(ndims, 0), count(hdf_dims);
+    start[0] = shard * rows_per_shard;
+    count[0] = std::min((hsize_t)rows_per_shard, hdf_dims[0] - start[0]);
+    hid_t src_space_id = H5Screate_simple(ndims, &(count[0]), NULL);
+    H5Sselect_hyperslab(dataspace_id, H5S_SELECT_SET, &(start[0]), NULL, &(count[0]), NULL);
+    H5Pset_virtual(plist_id, dataspace_id, shard_names.at(shard).c_str(), "data", src_space_id);
+    H5Sclose(src_space_id);
+  }
+  H5Sselect_all(dataspace_id);
+
+  hid_t dataset_id = H5Dcreate2(h5_file_id, varname, type_to_h5_type(type), dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
+  success = dataset_id >= 0;
+
+  H5Dclose(dataset_id);
+  H5Pclose(plist_id);
+  H5Sclose(dataspace_id);
+  h5_close_file(h5_file_id);
+
+  if (!success) {
+    std::cerr << ERROR_INFO << "Writing virtual dataset '" << varname << "' to file '" << filename << "' not possible." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+bool h5_check_soa_layout(char const* filename, char const* varname)
+{
+  return h5_check_attribute(filename, varname, "soa_fields");
+}
+
+bool h5_read_soa_layout(char const* filename, char const* varname, H5_Soa_Layout& layout)
+{
+  std::string field_list;
+  if (!h5_read_attribute_string(filename, varname, "soa_fields", field_list)) {
+    return false;
+  }
+
+  layout.fields.clear();
+  layout.types.clear();
+  layout.lanes.clear();
+  layout.offsets.clear();
+  layout.record_size = 0;
+  layout.mem_type.clear();
+
+  std::istringstream field_stream(field_list);
+  std::string field;
+  while (std::getline(field_stream, field, ',')) {
+    field.erase(0, field.find_first_not_of(" \t"));
+    field.erase(field.find_last_not_of(" \t") + 1);
+    if (!field.empty()) {
+      layout.fields.push_back(field);
+    }
+  }
+
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
+  hid_t dataset = H5Dopen(h5_file_id, varname, H5P_DEFAULT);
+  hid_t datatype = H5Dget_type(dataset);
+
+  bool success = true;
+  if (H5Tget_class(datatype) != H5T_COMPOUND || layout.fields.empty()) {
+    std::cerr << ERROR_INFO << "Fields of '" << varname << "' cannot be split into separate buffers." << std::endl;
+    success = false;
+  }
+
+  vector<hid_t> member_types;
+
+  for (size_t idx = 0; success && idx < layout.fields.size(); ++idx) {
+    int member = H5Tget_member_index(datatype, layout.fields.at(idx).c_str());
+    if (member < 0) {
+      std::cerr << ERROR_INFO << "Field '" << layout.fields.at(idx) << "' of '" << varname << "' not found." << std::endl;
+      success = false;
+      break;
+    }
+
+    // scalars or arrays of scalars
+    hid_t member_type = H5Tget_member_type(datatype, member);
+    size_t member_size, member_alignment;
+    hid_t mem_type = h5_device_type(member_type, member_size, member_alignment);
+    H5Tclose(member_type);
+    if (mem_type < 0) {
+      std::cerr << ERROR_INFO << "Data type of field '" << layout.fields.at(idx) << "' of '" << varname << "' is not supported." << std::endl;
+      success = false;
+      break;
+    }
+
+    hid_t scalar_type = H5Tcopy(mem_type);
+    size_t lanes = 1;
+    if (H5Tget_class(mem_type) == H5T_ARRAY) {
+      int ndims = H5Tget_array_ndims(mem_type);
+      vector<hsize_t> dims(ndims);
+      H5Tget_array_dims2(mem_type, &(dims[0]));
+      lanes = accumulate(dims.begin(), dims.end(), (size_t)1, std::multiplies<size_t>());
+      H5Tclose(scalar_type);
+      scalar_type = H5Tget_super(mem_type);
+    }
+
+    HD5_Type type = H5_uchar;
+    if (!h5_get_type(scalar_type, type)) {
+      std::cerr << ERROR_INFO << "Data type of field '" << layout.fields.at(idx) << "' of '" << varname << "' is not supported." << std::endl;
+      success = false;
+    }
+    H5Tclose(scalar_type);
+
+    layout.types.push_back(type);
+    layout.lanes.push_back(lanes);
+    layout.offsets.push_back(layout.record_size);
+    layout.record_size += H5Tget_size(mem_type);
+    member_types.push_back(mem_type);
+  }
+
+  if (success) {
+    hid_t record_type = H5Tcreate(H5T_COMPOUND, layout.record_size);
+    for (size_t idx = 0; idx < layout.fields.size(); ++idx) {
+      H5Tinsert(record_type, layout.fields.at(idx).c_str(), layout.offsets.at(idx), member_types.at(idx));
+    }
+
+    size_t nalloc = 0;
+    H5Tencode(record_type, NULL, &nalloc);
+    layout.mem_type.resize(nalloc);
+    H5Tencode(record_type, &(layout.mem_type[0]), &nalloc);
+    H5Tclose(record_type);
+  }
+
+  for (hid_t member_type : member_types) {
+    H5Tclose(member_type);
+  }
+  H5Tclose(datatype);
+  H5Dclose(dataset);
+  h5_close_file(h5_file_id);
+
+  return success;
+}
 
 
 // read a single item from an HDF5 file
@@ -342,10 +3144,10 @@ bool h5_write_single(char const* filename, char const* varname, TYPE data, std::
   hid_t h5_file_id;
 
   if (!fileExists(filename)) {
-    h5_file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    h5_file_id = h5_create_file(filename);
   }
   else {
-    h5_file_id = H5Fopen(filename, H5F_ACC_RDWR, H5P_DEFAULT);
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
   }
 
   H5LTmake_dataset(h5_file_id, varname, 0, NULL, type_to_h5_type<TYPE>(), &data);
@@ -358,7 +3160,7 @@ bool h5_write_single(char const* filename, char const* varname, TYPE data, std::
     H5LTset_attribute_string(h5_file_id, varname, "description", description.c_str());
   }
 
-  H5Fclose(h5_file_id);
+  h5_close_file(h5_file_id);
 
   return true;
 }
@@ -385,11 +3187,11 @@ bool h5_read_string(char const* filename, char const* varname, std::string& outp
     return false;
   }
 
-  hid_t h5_file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
   if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
     std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
     //TODO: Exception? Only error code?
-    H5Fclose(h5_file_id);
+    h5_close_file(h5_file_id);
     return false;
   }
 
@@ -411,7 +3213,7 @@ bool h5_read_string(char const* filename, char const* varname, std::string& outp
     if (err < 0) {
       std::cerr << ERROR_INFO << "Reading variable '" << varname << "' in file '" << filename << "' not possible." << std::endl;
       //TODO: Exception? Only error code?
-      H5Fclose(h5_file_id);
+      h5_close_file(h5_file_id);
       return false;
     }
     output = std::string(buffer.at(0));
@@ -427,7 +3229,7 @@ bool h5_read_string(char const* filename, char const* varname, std::string& outp
     if (err < 0) {
       std::cerr << ERROR_INFO << "Reading variable '" << varname << "' in file '" << filename << "' not possible." << std::endl;
       //TODO: Exception? Only error code?
-      H5Fclose(h5_file_id);
+      h5_close_file(h5_file_id);
       return false;
     }
     output = std::string(begin(buffer), end(buffer));
@@ -436,7 +3238,7 @@ bool h5_read_string(char const* filename, char const* varname, std::string& outp
   H5Sclose(dataspace);
   H5Tclose(datatype);
   H5Dclose(dataset);
-  H5Fclose(h5_file_id);
+  h5_close_file(h5_file_id);
 
   return true;
 }
@@ -446,15 +3248,15 @@ bool h5_write_string(char const* filename, char const* varname, std::string cons
   hid_t h5_file_id;
 
   if (!fileExists(filename)) {
-    h5_file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    h5_file_id = h5_create_file(filename);
   }
   else {
-    h5_file_id = H5Fopen(filename, H5F_ACC_RDWR, H5P_DEFAULT);
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
   }
 
   H5LTmake_dataset_string(h5_file_id, varname, buffer.c_str());
 
-  H5Fclose(h5_file_id);
+  h5_close_file(h5_file_id);
 
   return true;
 }
@@ -469,11 +3271,11 @@ bool h5_read_strings(char const* filename, char const* varname, std::vector<std:
     return false;
   }
 
-  hid_t h5_file_id = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t h5_file_id = h5_open_file(filename, H5F_ACC_RDONLY);
   if (H5LTpath_valid(h5_file_id, varname, true) <= 0) {
     std::cerr << ERROR_INFO << "Variable '" << varname << "' not found in file '" << filename << "'." << std::endl;
     //TODO: Exception? Only error code?
-    H5Fclose(h5_file_id);
+    h5_close_file(h5_file_id);
     return false;
   }
 
@@ -495,7 +3297,7 @@ bool h5_read_strings(char const* filename, char const* varname, std::vector<std:
     if (err < 0) {
       std::cerr << ERROR_INFO << "Reading variable '" << varname << "' in file '" << filename << "' not possible." << std::endl;
       //TODO: Exception? Only error code?
-      H5Fclose(h5_file_id);
+      h5_close_file(h5_file_id);
       return false;
     }
 
@@ -517,7 +3319,7 @@ bool h5_read_strings(char const* filename, char const* varname, std::vector<std:
     if (err < 0) {
       std::cerr << ERROR_INFO << "Reading variable '" << varname << "' in file '" << filename << "' not possible." << std::endl;
       //TODO: Exception? Only error code?
-      H5Fclose(h5_file_id);
+      h5_close_file(h5_file_id);
       return false;
     }
 
@@ -531,7 +3333,7 @@ bool h5_read_strings(char const* filename, char const* varname, std::vector<std:
   H5Sclose(dataspace);
   H5Tclose(datatype);
   H5Dclose(dataset);
-  H5Fclose(h5_file_id);
+  h5_close_file(h5_file_id);
 
   return true;
 }
@@ -553,21 +3355,21 @@ bool h5_write_strings(char const* filename, char const* varname, std::vector<std
   // save buffer and additional information
   hid_t h5_file_id;
   if (!fileExists(filename)) {
-    h5_file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    h5_file_id = h5_create_file(filename);
   }
   else {
-    h5_file_id = H5Fopen(filename, H5F_ACC_RDWR, H5P_DEFAULT);
+    h5_file_id = h5_open_file(filename, H5F_ACC_RDWR);
   }
 
   hsize_t hdf_dims[1] = { lines.size() };
-  hsize_t chunk_dims[1] = { (hsize_t)(hdf_dims[0] / chunk_factor) + 1 };
+  vector<hsize_t> chunk_dims = h5_chunk_dims(vector<hsize_t>(1, hdf_dims[0]), line_length, vector<size_t>());
 
   hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
-  H5Pset_chunk(plist_id, 1, chunk_dims);
-  H5Pset_deflate(plist_id, 9);
+  H5Pset_chunk(plist_id, 1, &(chunk_dims[0]));
 
   hid_t dataspace_id = H5Screate_simple(1, hdf_dims, NULL);
   hid_t datatype_id = H5Tcreate(H5T_STRING, line_length);
+  h5_set_filters(plist_id, datatype_id, buffer.data(), buffer.size());
   hid_t dataset_id = H5Dcreate2(h5_file_id, varname, datatype_id, dataspace_id, H5P_DEFAULT, plist_id, H5P_DEFAULT);
 
   H5Dwrite(dataset_id, datatype_id, dataspace_id, dataspace_id, H5P_DEFAULT, buffer.data());
@@ -577,7 +3379,7 @@ bool h5_write_strings(char const* filename, char const* varname, std::vector<std
   H5Tclose(datatype_id);
   H5Sclose(dataspace_id);
 
-  H5Fclose(h5_file_id);
+  h5_close_file(h5_file_id);
 
   return true;
 }
@@ -0,0 +1,80 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <algorithm>
+#include <cstring>
+
+#include "layout_transform.hpp"
+
+
+// number of records processed at once; 16 KiB of 32 byte records fit into the L1 cache
+static const size_t block_records = 512;
+
+
+// Copy a field of the records [begin, end). The fixed size TYPE lets the
+// compiler use a single (vectorized) load and store per element; memcpy avoids
+// unaligned accesses via misaligned pointers.
+template<typename TYPE>
+static inline void gather_field(uint8_t const* aos, size_t record_size, size_t offset, size_t begin, size_t end, uint8_t* field)
+{
+  for (size_t record = begin; record < end; ++record) {
+    TYPE value;
+    memcpy(&value, aos + record * record_size + offset, sizeof(TYPE));
+    memcpy(field + record * sizeof(TYPE), &value, sizeof(TYPE));
+  }
+}
+
+template<typename TYPE>
+static inline void scatter_field(uint8_t const* field, size_t record_size, size_t offset, size_t begin, size_t end, uint8_t* aos)
+{
+  for (size_t record = begin; record < end; ++record) {
+    TYPE value;
+    memcpy(&value, field + record * sizeof(TYPE), sizeof(TYPE));
+    memcpy(aos + record * record_size + offset, &value, sizeof(TYPE));
+  }
+}
+
+
+void aos_to_soa(uint8_t const* aos, size_t num_records, size_t record_size,
+  std::vector<size_t> const& offsets, std::vector<size_t> const& sizes, std::vector<uint8_t*> const& soa)
+{
+  for (size_t begin = 0; begin < num_records; begin += block_records) {
+    size_t end = std::min(begin + block_records, num_records);
+
+    for (size_t field = 0; field < offsets.size(); ++field) {
+      size_t const offset = offsets.at(field);
+      switch (sizes.at(field)) {
+        case 1: gather_field<uint8_t>( aos, record_size, offset, begin, end, soa.at(field)); break;
+        case 2: gather_field<uint16_t>(aos, record_size, offset, begin, end, soa.at(field)); break;
+        case 4: gather_field<uint32_t>(aos, record_size, offset, begin, end, soa.at(field)); break;
+        case 8: gather_field<uint64_t>(aos, record_size, offset, begin, end, soa.at(field)); break;
+        default:
+          for (size_t record = begin; record < end; ++record) {
+            memcpy(soa.at(field) + record * sizes.at(field), aos + record * record_size + offset, sizes.at(field));
+          }
+      }
+    }
+  }
+}
+
+
+void soa_to_aos(std::vector<uint8_t const*> const& soa, size_t num_records, size_t record_size,
+  std::vector<size_t> const& offsets, std::vector<size_t> const& sizes, uint8_t* aos)
+{
+  for (size_t begin = 0; begin < num_records; begin += block_records) {
+    size_t end = std::min(begin + block_records, num_records);
+
+    for (size_t field = 0; field < offsets.size(); ++field) {
+      size_t const offset = offsets.at(field);
+      switch (sizes.at(field)) {
+        case 1: scatter_field<uint8_t>( soa.at(field), record_size, offset, begin, end, aos); break;
+        case 2: scatter_field<uint16_t>(soa.at(field), record_size, offset, begin, end, aos); break;
+        case 4: scatter_field<uint32_t>(soa.at(field), record_size, offset, begin, end, aos); break;
+        case 8: scatter_field<uint64_t>(soa.at(field), record_size, offset, begin, end, aos); break;
+        default:
+          for (size_t record = begin; record < end; ++record) {
+            memcpy(aos + record * record_size + offset, soa.at(field) + record * sizes.at(field), sizes.at(field));
+          }
+      }
+    }
+  }
+}
@@ -4,7 +4,10 @@
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <new>
 #include <math.h>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -17,6 +20,16 @@
 #include "util.hpp"
 #include "hdf5_io.hpp"
 #include "ocl_dev_mgr.hpp"
+#include "data_generator.hpp"
+#include "data_image.hpp"
+#include "layout_transform.hpp"
+#include "sparse_matrix.hpp"
+#include "type_conversion.hpp"
+#include "staging_arena.hpp"
+#include "file_mapping.hpp"
+#include "output_backend.hpp"
+#include "result_cache.hpp"
+#include "svm_memory.hpp"
 #include "timer.hpp"
 
 #if defined(_WIN32)
@@ -578,6 +591,83 @@ std::string getOS()
 
 
 
+// Access of the buffers in `/data` by the kernels. Read only buffers are not
+// copied back to the host and write only buffers are not initialized using the
+// data of the input file.
+enum Data_Access { access_read_write, access_read_only, access_write_only };
+
+// A buffer is read only if all kernels using it declare the corresponding
+// argument as `const` or `constant`. Write only buffers cannot be detected
+// using the kernel signatures; they have to be marked explicitly.
+Data_Access get_data_access(ocl_dev_mgr& dev_mgr, std::vector<std::string> const& kernel_list, cl_uint arg_idx)
+{
+ bool written = false;
+
+ for (string const& kernel_name : kernel_list) {
+  cl::Kernel* kernel = dev_mgr.getKernelbyName(0, "ocl_Kernel", kernel_name);
+  try {
+   cl_uint num_args = 0;
+   kernel->getInfo(CL_KERNEL_NUM_ARGS, &num_args);
+   if (arg_idx >= num_args) {
+    continue;
+   }
+
+   cl_kernel_arg_address_qualifier address_qualifier;
+   cl_kernel_arg_type_qualifier type_qualifier;
+   cl_kernel_arg_access_qualifier access_qualifier;
+   kernel->getArgInfo(arg_idx, CL_KERNEL_ARG_ADDRESS_QUALIFIER, &address_qualifier);
+   kernel->getArgInfo(arg_idx, CL_KERNEL_ARG_TYPE_QUALIFIER, &type_qualifier);
+   kernel->getArgInfo(arg_idx, CL_KERNEL_ARG_ACCESS_QUALIFIER, &access_qualifier);
+   if (access_qualifier != CL_KERNEL_ARG_ACCESS_NONE) {
+    // images are read only unless declared as write_only or read_write
+    if (access_qualifier != CL_KERNEL_ARG_ACCESS_READ_ONLY) {
+     written = true;
+    }
+   }
+   else if ((address_qualifier != CL_KERNEL_ARG_ADDRESS_CONSTANT) && !(type_qualifier & CL_KERNEL_ARG_TYPE_CONST)) {
+    written = true;
+   }
+  }
+  catch (cl::Error err) {
+   // no argument information available; assume the worst case
+   written = true;
+  }
+ }
+
+ return written ? access_read_write : access_read_only;
+}
+
+
+// Number of lanes of the OpenCL vector type pointed to by a kernel argument,
+// e.g. 3 for `global float3*`, or 1 if it is not a vector type.
+size_t get_vector_lanes(ocl_dev_mgr& dev_mgr, std::vector<std::string> const& kernel_list, cl_uint arg_idx)
+{
+ for (string const& kernel_name : kernel_list) {
+  cl::Kernel* kernel = dev_mgr.getKernelbyName(0, "ocl_Kernel", kernel_name);
+  try {
+   cl_uint num_args = 0;
+   kernel->getInfo(CL_KERNEL_NUM_ARGS, &num_args);
+   if (arg_idx >= num_args) {
+    continue;
+   }
+
+   string type_name;
+   kernel->getArgInfo(arg_idx, CL_KERNEL_ARG_TYPE_NAME, &type_name);
+   type_name = type_name.substr(0, type_name.find_first_of("* "));
+   size_t digits = type_name.find_last_not_of("0123456789") + 1;
+   if (digits < type_name.size()) {
+    return stoul(type_name.substr(digits));
+   }
+  }
+  catch (cl::Error err) {
+   // no argument information available
+  }
+ }
+
+ return 1;
+}
+
+
 void print_help()
 {
  cout
@@ -588,7 +678,33 @@ void print_help()
   << " -b: \n"
     "  Activate the benchmark mode (additional delay before & after runs)." << endl
   << " -c config.h5: \n"
-    "  Specify the URL `config.h5` of the HDF5 configuration file." << endl
+    "  Specify the URL `config.h5` of the HDF5 configuration file. If given several times,\n"
+    "  objects of later files shadow those of earlier files." << endl
+  << " -cache directory: \n"
+    "  Take the output file from the result cache in `directory` if the inputs are unchanged." << endl
+  << " -force: \n"
+    "  Execute the kernels even if the result cache contains the output file." << endl
+  << " -set name=value: \n"
+    "  Replace the dataset `name` of the configuration, e.g. `settings/kernel_repetitions=1000`." << endl
+  << " -huge_pages: \n"
+    "  Use huge pages for the host memory of data transfers (if available)." << endl
+  << " -svm: \n"
+    "  Use shared virtual memory for the datasets (if supported by the device)." << endl
+  << " -link_inputs: \n"
+    "  Link read only datasets to the input files instead of copying them; the output file\n"
+    "  is then only readable while the input files exist." << endl
+  << " -compression filters: \n"
+    "  Compress the output datasets using `filters`, e.g. `shuffle,deflate:1` or `auto`." << endl
+  << " -io_threads n: \n"
+    "  Compress and decompress datasets on `n` threads (default: all hardware threads)." << endl
+  << " -output format: \n"
+    "  Store the output datasets as `hdf5` (default), `npy`, `npy:direct`, `shm`, or `shm:keep`." << endl
+  << " -data_url data.h5: \n"
+    "  Read the datasets missing in the configuration file from `/data` of `data.h5`." << endl
+  << " -shard_size bytes: \n"
+    "  Split output datasets larger than `bytes` into shard files joined by virtual datasets." << endl
+  << " -chunk_size bytes: \n"
+    "  Chunk the output datasets into chunks of about `bytes` (default: 1048576)." << endl
 #if defined(USENVML)
   << " -nvidia_power sample_rate: \n"
     "  Log Nvidia GPU power consumption with `sample_rate` (ms)" << endl
@@ -623,6 +739,18 @@ int main(int argc, char *argv[]) {
  // default options
  cl_uint deviceIndex = 0;
  bool benchmark_mode = false;
+ bool huge_pages = false;
+ bool use_svm = false;
+ bool link_inputs = false;
+ char const* compression_spec = nullptr;
+ cl_ulong chunk_size = 0;
+ cl_ulong shard_size = 0;
+ char const* output_spec = nullptr;
+ char const* data_url_spec = nullptr;
+ std::vector<std::string> config_files;
+ std::vector<std::string> config_settings;
+ char const* cache_dir = nullptr;
+ bool force_execution = false;
  char const* filename = nullptr;
 
  // parse command line arguments starting at index 1 (because toolkitICL is the 0th argument)
@@ -636,6 +764,63 @@ int main(int argc, char *argv[]) {
    benchmark_mode = true;
    cout << "Benchmark mode" << endl << endl;
   }
+  else if (argv[option_idx] == string("-huge_pages")) {
+   huge_pages = true;
+  }
+  else if (argv[option_idx] == string("-svm")) {
+   use_svm = true;
+  }
+  else if (argv[option_idx] == string("-link_inputs")) {
+   link_inputs = true;
+  }
+  else if (argv[option_idx] == string("-compression")) {
+   ++option_idx;
+   compression_spec = argv[option_idx];
+  }
+  else if (argv[option_idx] == string("-io_threads")) {
+   ++option_idx;
+   int io_threads = 0;
+   try {
+    io_threads = stoi(argv[option_idx]);
+   }
+   catch (const std::exception& e) {
+    cerr << "Error: Could not convert '" << argv[option_idx] << "' to an integer." << endl;
+    throw(e);
+   }
+   if (io_threads < 1) {
+    cerr << "Error: The number of I/O threads must be at least 1, but is " << io_threads << "." << endl;
+    return -1;
+   }
+   h5_set_threads(io_threads);
+  }
+  else if (argv[option_idx] == string("-output")) {
+   ++option_idx;
+   output_spec = argv[option_idx];
+  }
+  else if (argv[option_idx] == string("-data_url")) {
+   ++option_idx;
+   data_url_spec = argv[option_idx];
+  }
+  else if (argv[option_idx] == string("-shard_size")) {
+   ++option_idx;
+   try {
+    shard_size = stoull(argv[option_idx]);
+   }
+   catch (const std::exception& e) {
+    cerr << "Error: Could not convert '" << argv[option_idx] << "' to an integer." << endl;
+    throw(e);
+   }
+  }
+  else if (argv[option_idx] == string("-chunk_size")) {
+   ++option_idx;
+   try {
+    chunk_size = stoull(argv[option_idx]);
+   }
+   catch (const std::exception& e) {
+    cerr << "Error: Could not convert '" << argv[option_idx] << "' to an integer." << endl;
+    throw(e);
+   }
+  }
   else if (argv[option_idx] == string("-d")) {
    ++option_idx;
    try {
@@ -648,7 +833,18 @@ int main(int argc, char *argv[]) {
   }
   else if (argv[option_idx] == string("-c")) {
    ++option_idx;
-   filename = argv[option_idx];
+   config_files.push_back(argv[option_idx]);
+  }
+  else if (argv[option_idx] == string("-cache")) {
+   ++option_idx;
+   cache_dir = argv[option_idx];
+  }
+  else if (argv[option_idx] == string("-force")) {
+   force_execution = true;
+  }
+  else if (argv[option_idx] == string("-set") || argv[option_idx] == string("--set")) {
+   ++option_idx;
+   config_settings.push_back(argv[option_idx]);
   }
 #if defined(USENVML)
   else if (argv[option_idx] == string("-nvidia_power")) {
@@ -730,12 +926,32 @@ int main(int argc, char *argv[]) {
  }
 
  // check necessary/incompatible command line arguments
- if (filename == nullptr) {
+ if (config_files.empty()) {
   cerr << "Error: A configuration file must be given as command line argument." << endl;
   print_help();
   return -1;
  }
 
+ // the output file is named after the last configuration file
+ string out_name = config_files.back();
+ out_name = "out_" + out_name.substr(out_name.find_last_of("/\\") + 1);
+
+ // A stack of configuration files, e.g. a small file with settings on top of a file
+ // with the data, and single settings are merged into a configuration file next to
+ // the output file, which records the effective configuration of the run.
+ string merged_name;
+ if (config_files.size() > 1 || !config_settings.empty()) {
+  merged_name = out_name.substr(0, out_name.find_last_of('.')) + ".config.h5";
+  if (!h5_merge_files(config_files, config_settings, merged_name.c_str())) {
+   cerr << ERROR_INFO << "Merging the configuration files not possible." << endl;
+   return -1;
+  }
+  filename = merged_name.c_str();
+ }
+ else {
+  filename = config_files.back().c_str();
+ }
+
 #if defined(USEAMDP)
  if (amd_log_temp && amd_log_power) {
   cerr << endl << "Error: Concurrent logging on AMD systems is not suported, yet!" << endl;
@@ -752,6 +968,9 @@ int main(int argc, char *argv[]) {
  }
  dev_mgr.init_device(deviceIndex);
 
+ // the configuration file is kept open until all data are written
+ h5_file_session input_file(filename, false);
+
  string kernel_url;
  if (h5_check_object(filename, "kernel_url") == true) {
    h5_read_string(filename, "kernel_url", kernel_url);
@@ -795,9 +1014,75 @@ int main(int argc, char *argv[]) {
  string settings;
  h5_read_string(filename, "settings/kernel_settings", settings);
 
+ // the compression of the output datasets is given by the command line or the configuration file
+ string compression = "deflate:9";
+ if (compression_spec != nullptr) {
+  compression = compression_spec;
+ }
+ else if (h5_check_object(filename, "settings/compression")) {
+  h5_read_string(filename, "settings/compression", compression);
+  compression = compression.c_str();
+ }
+ H5_Compression global_compression;
+ if (!h5_parse_compression(compression, global_compression)) {
+  return -1;
+ }
+ h5_set_compression(global_compression);
+
+ // the target size of the chunks of output datasets not chunked in the input file
+ if (chunk_size == 0 && h5_check_object(filename, "settings/chunk_size")) {
+  chunk_size = h5_read_single<cl_ulong>(filename, "settings/chunk_size");
+ }
+ if (chunk_size > 0) {
+  h5_set_chunk_size(chunk_size);
+ }
+
+ // output datasets larger than the shard size are split into several files
+ if (shard_size == 0 && h5_check_object(filename, "settings/shard_size")) {
+  shard_size = h5_read_single<cl_ulong>(filename, "settings/shard_size");
+ }
+
+ // the output datasets are stored in the HDF5 output file or as separate files
+ string output_format = "hdf5";
+ if (output_spec != nullptr) {
+  output_format = output_spec;
+ }
+ else if (h5_check_object(filename, "settings/output_format")) {
+  h5_read_string(filename, "settings/output_format", output_format);
+  output_format = output_format.c_str();
+ }
+
+ // the datasets in `/data` of a shared data file complement those of the config file;
+ // relative names are resolved from the directory of the config file first, as for external links
+ string data_url;
+ if (data_url_spec != nullptr) {
+  data_url = data_url_spec;
+ }
+ else if (h5_check_object(filename, "settings/data_url")) {
+  h5_read_string(filename, "settings/data_url", data_url);
+  data_url = data_url.c_str();
+ }
+ if (!data_url.empty()) {
+  string config_dir = filename;
+  config_dir = config_dir.substr(0, config_dir.find_last_of("/\\") + 1);
+  if (!config_dir.empty() && data_url.front() != '/' && data_url.front() != '\\' && fileExists(config_dir + data_url)) {
+   data_url = config_dir + data_url;
+  }
+  if (!fileExists(data_url)) {
+   cerr << ERROR_INFO << "Data file '" << data_url << "' not found." << endl;
+   return -1;
+  }
+ }
+ // as the configuration file, the data file is kept open until all data are read
+ std::unique_ptr<h5_file_session> data_url_file;
+ if (!data_url.empty() && !h5_has_session(data_url.c_str())) {
+  data_url_file.reset(new h5_file_session(data_url, false));
+ }
+
 
  uint64_t num_kernels_found = 0;
- num_kernels_found = dev_mgr.compile_kernel(0, "ocl_Kernel", settings);
+ // the argument information is used to detect read only buffers
+ num_kernels_found = dev_mgr.compile_kernel(0, "ocl_Kernel", settings + " -cl-kernel-arg-info");
  if (num_kernels_found == 0) {
   cerr << ERROR_INFO << "No valid kernels found" << endl;
   return -1;
@@ -825,116 +1110,664 @@ int main(int argc, char *argv[]) {
  std::vector<std::string> data_names;
  std::vector<HD5_Type> data_types;
  std::vector<size_t> data_sizes;
- h5_get_content(filename, "/data/", data_names, data_types, data_sizes);
+ std::vector<std::vector<size_t>> data_dims;
+ h5_get_content(filename, "/data/", data_names, data_types, data_sizes, data_dims);
+
+ // datasets of the data file are used unless the config file has an object of the same name
+ std::map<std::string, std::string> data_sources;
+ for (std::string const& name : data_names) {
+  data_sources[name] = filename;
+ }
+ if (!data_url.empty()) {
+  std::vector<std::string> url_names;
+  std::vector<HD5_Type> url_types;
+  std::vector<size_t> url_sizes;
+  std::vector<std::vector<size_t>> url_dims;
+  h5_get_content(data_url.c_str(), "/data/", url_names, url_types, url_sizes, url_dims);
+  for (size_t i = 0; i < url_names.size(); i++) {
+   if (!h5_check_object(filename, url_names.at(i).c_str())) {
+    data_names.push_back(url_names.at(i));
+    data_types.push_back(url_types.at(i));
+    data_sizes.push_back(url_sizes.at(i));
+    data_dims.push_back(url_dims.at(i));
+    data_sources[url_names.at(i)] = data_url;
+   }
+  }
+
+  // the datasets are bound in the order of their names
+  std::vector<size_t> order(data_names.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return data_names.at(a) < data_names.at(b); });
+  std::vector<std::string> names;
+  std::vector<HD5_Type> types;
+  std::vector<size_t> sizes;
+  std::vector<std::vector<size_t>> dims;
+  for (size_t idx : order) {
+   names.push_back(data_names.at(idx));
+   types.push_back(data_types.at(idx));
+   sizes.push_back(data_sizes.at(idx));
+   dims.push_back(data_dims.at(idx));
+  }
+  data_names.swap(names);
+  data_types.swap(types);
+  data_sizes.swap(sizes);
+  data_dims.swap(dims);
+ }
+
+ // compound datasets with an attribute `soa_fields` are split into one buffer per
+ // field; the fields keep the name of the dataset and are consecutive kernel arguments
+ std::vector<H5_Soa_Layout> soa_layouts;
+ std::vector<bool> data_split;
+ std::vector<size_t> data_soa_group, data_soa_field;
+ {
+  std::vector<std::string> names;
+  std::vector<HD5_Type> types;
+  std::vector<size_t> sizes;
+  std::vector<std::vector<size_t>> dims;
+  for (cl_uint i = 0; i < data_names.size(); i++) {
+   H5_Soa_Layout soa;
+   char const* data_file = data_sources.at(data_names.at(i)).c_str();
+   if (data_types.at(i) == H5_compound && h5_check_soa_layout(data_file, data_names.at(i).c_str())
+       && h5_read_soa_layout(data_file, data_names.at(i).c_str(), soa)) {
+    soa_layouts.push_back(soa);
+    for (size_t field = 0; field < soa.fields.size(); field++) {
+     names.push_back(data_names.at(i));
+     types.push_back(soa.types.at(field));
+     sizes.push_back(data_sizes.at(i) * soa.lanes.at(field));
+     dims.push_back(data_dims.at(i));
+     data_split.push_back(true);
+     data_soa_group.push_back(soa_layouts.size() - 1);
+     data_soa_field.push_back(field);
+    }
+   }
+   else {
+    names.push_back(data_names.at(i));
+    types.push_back(data_types.at(i));
+    sizes.push_back(data_sizes.at(i));
+    dims.push_back(data_dims.at(i));
+    data_split.push_back(false);
+    data_soa_group.push_back(0);
+    data_soa_field.push_back(0);
+   }
+  }
+  data_names.swap(names);
+  data_types.swap(types);
+  data_sizes.swap(sizes);
+  data_dims.swap(dims);
+ }
+
+ // groups of sparse matrices are bound as buffers and scalars to consecutive
+ // kernel arguments, starting at the position of the group in `/data`
+ std::vector<sparse_arguments> sparse_matrices;
+ std::vector<bool> data_sparse(data_names.size(), false);
+ std::vector<size_t> data_sparse_group(data_names.size(), 0), data_sparse_arg(data_names.size(), 0);
+ {
+  std::vector<std::string> group_names;
+  h5_get_groups(filename, "/data/", group_names);
+  for (std::string const& group : group_names) {
+   data_sources[group] = filename;
+  }
+  if (!data_url.empty()) {
+   std::vector<std::string> url_groups;
+   h5_get_groups(data_url.c_str(), "/data/", url_groups);
+   for (std::string const& group : url_groups) {
+    if (!h5_check_object(filename, group.c_str())) {
+     group_names.push_back(group);
+     data_sources[group] = data_url;
+    }
+   }
+   std::sort(group_names.begin(), group_names.end());
+  }
+
+  for (std::string const& group : group_names) {
+   char const* data_file = data_sources.at(group).c_str();
+   sparse_matrix matrix;
+   sparse_arguments arguments;
+   if (!check_sparse_matrix(data_file, group.c_str()) || !read_sparse_matrix(data_file, group.c_str(), matrix)
+       || !get_sparse_arguments(matrix, arguments)) {
+    continue;
+   }
+   sparse_matrices.push_back(arguments);
+
+   // the arguments keep the name of the group, which is sorted as the datasets
+   size_t const pos = std::upper_bound(data_names.begin(), data_names.end(), group) - data_names.begin();
+   size_t const count = arguments.names.size();
+   data_names.insert(data_names.begin() + pos, count, group);
+   data_types.insert(data_types.begin() + pos, arguments.types.begin(), arguments.types.end());
+   data_sizes.insert(data_sizes.begin() + pos, arguments.sizes.begin(), arguments.sizes.end());
+   for (size_t arg = 0; arg < count; arg++) {
+    data_dims.insert(data_dims.begin() + pos + arg, std::vector<size_t>(1, arguments.sizes.at(arg)));
+    data_sparse_arg.insert(data_sparse_arg.begin() + pos + arg, arg);
+   }
+   data_split.insert(data_split.begin() + pos, count, false);
+   data_soa_group.insert(data_soa_group.begin() + pos, count, 0);
+   data_soa_field.insert(data_soa_field.begin() + pos, count, 0);
+   data_sparse.insert(data_sparse.begin() + pos, count, true);
+   data_sparse_group.insert(data_sparse_group.begin() + pos, count, sparse_matrices.size() - 1);
+  }
+ }
+
+ // the file every dataset is read from, i.e. the config file or the data file
+ std::vector<std::string> data_files;
+ for (std::string const& name : data_names) {
+  data_files.push_back(data_sources.at(name));
+ }
+
+ // datasets with an attribute `device_type` are converted on the host between
+ // the type stored in the file and the type used by the kernels
+ std::vector<HD5_Type> data_storage_types(data_types);
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  HD5_Type device_type;
+  if (!data_split.at(i) && !data_sparse.at(i) && data_types.at(i) != H5_compound && check_device_type(data_files.at(i).c_str(), data_names.at(i).c_str())
+      && read_device_type(data_files.at(i).c_str(), data_names.at(i).c_str(), device_type)) {
+   data_types.at(i) = device_type;
+  }
+ }
+
+ // the shapes and chunk layouts of the input datasets are kept for the output
+ std::vector<std::vector<size_t>> data_chunks(data_names.size());
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  if (!data_sparse.at(i)) {
+   h5_get_chunk_dims(data_files.at(i).c_str(), data_names.at(i).c_str(), data_chunks.at(i));
+  }
+ }
+
+ // vector and compound datasets are aligned as the corresponding OpenCL C types
+ std::vector<H5_Device_Layout> data_layouts(data_names.size());
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  size_t lanes = get_vector_lanes(dev_mgr, kernel_list, i);
+  if (data_split.at(i) || data_sparse.at(i)) {
+   data_layouts.at(i) = H5_Device_Layout{data_sizes.at(i), 1, get_type_size(data_types.at(i)), {}};
+  }
+  else {
+   h5_get_device_layout(data_files.at(i).c_str(), data_names.at(i).c_str(), lanes, data_layouts.at(i));
+  }
+
+  if (data_types.at(i) != data_storage_types.at(i)) {
+   H5_Device_Layout& layout = data_layouts.at(i);
+   if (!h5_is_flat_layout(layout)) {
+    cerr << ERROR_INFO << "Device types of vector datasets like '" << data_names.at(i) << "' are not supported." << endl;
+    data_types.at(i) = data_storage_types.at(i);
+    continue;
+   }
+   layout.element_size = layout.element_size / get_type_size(data_storage_types.at(i)) * get_type_size(data_types.at(i));
+  }
+ }
+
+ // datasets with an attribute `image_channel_order` are bound as images instead of buffers
+ std::vector<data_image> data_images(data_names.size());
+ std::vector<bool> data_is_image(data_names.size(), false);
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  if (!data_split.at(i) && !data_sparse.at(i) && check_image(data_files.at(i).c_str(), data_names.at(i).c_str())) {
+   if (!h5_is_flat_layout(data_layouts.at(i))) {
+    cerr << ERROR_INFO << "Images of vector and compound datasets like '" << data_names.at(i) << "' are not supported." << endl;
+    continue;
+   }
+   data_is_image.at(i) = read_image(data_files.at(i).c_str(), data_names.at(i).c_str(), data_types.at(i), data_dims.at(i), data_images.at(i));
+  }
+ }
+
+ // datasets referring to the same object share a single buffer
+ std::vector<size_t> data_aliases;
+ h5_get_aliases(data_files, data_names, data_aliases);
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  if (data_split.at(i) || data_split.at(data_aliases.at(i)) || data_is_image.at(i) || data_is_image.at(data_aliases.at(i))
+      || data_sparse.at(i) || data_sparse.at(data_aliases.at(i))) {
+   data_aliases.at(i) = i;
+  }
+ }
+
+ // With a result cache, the output file of an earlier run with the same inputs is
+ // used instead of executing the kernels again, unless the execution is forced.
+ // The key is a hash of the kernel source and its includes, the settings, the device,
+ // the command line options, the names of the input files and the data.
+ bool use_cache = (cache_dir != nullptr);
+ uint64_t cache_key = 0;
+ if (use_cache && (output_format != "hdf5" || shard_size > 0)) {
+  cout << "The result cache supports HDF5 output files without shards only; it is not used." << endl;
+  use_cache = false;
+ }
+ if (use_cache) {
+  uint64_t hash = hash_combine(0, string("toolkitICL result cache 1"));
+
+  hash = hash_kernel_source(kernel_url, settings, hash);
+  hash = hash_combine(hash, settings);
+  for (string const& kernel : kernel_list) {
+   hash = hash_combine(hash, kernel);
+  }
+  hash = hash_combine(hash, (uint64_t)kernel_repetitions);
+
+  ocl_dev_mgr::ocl_device_info& device_info = dev_mgr.get_avail_dev_info(deviceIndex);
+  string driver_version;
+  dev_mgr.get_context_dev_info(0, 0).device.getInfo(CL_DRIVER_VERSION, &driver_version);
+  for (string const& identity : {device_info.platform_name, device_info.vendor, device_info.name, device_info.ocl_version, driver_version}) {
+   hash = hash_combine(hash, identity);
+  }
+
+  // the output file refers to the input files by name, i.e. by `/settings/config_files`
+  // and, with -link_inputs, by the external links of read only datasets, so their names are part of the key
+  for (string const& config_file : config_files) {
+   hash = hash_combine(hash, config_file);
+  }
+  for (int option_idx = 1; option_idx < argc; ++option_idx) {
+   if (argv[option_idx] == string("-c") || argv[option_idx] == string("-cache")) {
+    ++option_idx;
+   }
+   else if (argv[option_idx] != string("-force")) {
+    hash = hash_combine(hash, string(argv[option_idx]));
+   }
+  }
+
+  bool hashed = !h5_check_object(filename, "settings") || h5_hash_object(filename, "/settings", hash);
+  for (cl_uint i = 0; i < data_names.size(); i++) {
+   if (i == 0 || data_names.at(i) != data_names.at(i - 1)) {
+    hash = hash_combine(hash, data_files.at(i));
+    hashed = hashed && h5_hash_object(data_files.at(i), data_names.at(i).c_str(), hash);
+   }
+  }
+  if (!hashed) {
+   cout << "The inputs cannot be hashed; the result cache is not used." << endl;
+  }
+  use_cache = hashed;
+  cache_key = hash;
+ }
+ if (use_cache && !force_execution && result_cache(cache_dir).fetch(cache_key, out_name)) {
+  cout << "Output file " << out_name << " taken from the result cache." << endl;
+  return 0;
+ }
 
  cout << "Creating output HDF5 file..." << endl;
- string out_name = filename;
- out_name = "out_" + out_name.substr(out_name.find_last_of("/\\") + 1);
 
  if (fileExists(out_name)) {
   remove(out_name.c_str());
   cout << "Old HDF5 data file found and deleted!" << endl;
  }
+ h5_file_session output_file(out_name, true);
+ std::unique_ptr<output_backend> output = create_output_backend(output_format, out_name, shard_size);
+ if (!output) {
+  return -1;
+ }
+ // read only datasets and groups are unchanged; they are copied from the input file or linked to it
+ auto store_input = [&output, link_inputs](std::string const& name, std::string const& input_filename) {
+  return link_inputs ? output->link_input(name.c_str(), input_filename.c_str())
+                     : output->copy_input(name.c_str(), input_filename.c_str());
+ };
 
  h5_create_dir(out_name, "/settings");
  h5_write_string(out_name, "/settings/kernel_settings", settings);
  h5_write_single<cl_ulong>(out_name, "/settings/kernel_repetitions", kernel_repetitions);
+ if (!merged_name.empty()) {
+  h5_write_strings(out_name, "/settings/config_files", config_files);
+  if (!config_settings.empty()) {
+   h5_write_strings(out_name, "/settings/config_settings", config_settings);
+  }
+  h5_write_string(out_name, "/settings/config", merged_name);
+ }
+
+ // shared virtual memory is used for the buffers if requested and supported by the device;
+ // it is created before the buffers, since it has to outlive them
+ if (use_svm && !svm_memory::is_supported(dev_mgr.get_context_dev_info(0, 0).device)) {
+  cout << "Shared virtual memory is not supported by the device; using buffers instead." << endl;
+  use_svm = false;
+ }
+ svm_memory svm(dev_mgr.get_context(0), dev_mgr.get_queue(0, 0), dev_mgr.get_context_dev_info(0, 0).device);
+ std::vector<void*> data_svm(data_names.size(), nullptr);
+
+ // mappings of the input file; created before the buffers, since buffers using
+ // the mapped data as host memory have to be released first
+ file_mapper mapped_files;
+ bool cpu_device = dev_mgr.get_context_dev_info(0, 0).type == CL_DEVICE_TYPE_CPU;
+ cl_uint base_alignment = 8; // bits
+ dev_mgr.get_context_dev_info(0, 0).device.getInfo(CL_DEVICE_MEM_BASE_ADDR_ALIGN, &base_alignment);
+ base_alignment = std::max(base_alignment / 8, (cl_uint)1);
 
  std::vector<cl::Buffer> data_in;
  bool blocking = CL_TRUE;
 
- //TODO: Implement functionality! Allow other integer types instead of cl_int?
- vector<cl_int> data_rw_flags(data_names.size(), 0);
+ // the access can be overwritten using the attribute `access` of a dataset
+ vector<Data_Access> data_rw_flags(data_names.size(), access_read_write);
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  // sparse matrices are input data only
+  if (data_sparse.at(i)) {
+   data_rw_flags.at(i) = access_read_only;
+   continue;
+  }
+
+  data_rw_flags.at(i) = get_data_access(dev_mgr, kernel_list, i);
+
+  if (h5_check_attribute(data_files.at(i).c_str(), data_names.at(i).c_str(), "access")) {
+   string access;
+   h5_read_attribute_string(data_files.at(i).c_str(), data_names.at(i).c_str(), "access", access);
+   if (access == "read_write") {
+    data_rw_flags.at(i) = access_read_write;
+   }
+   else if (access == "read_only") {
+    data_rw_flags.at(i) = access_read_only;
+   }
+   else if (access == "write_only") {
+    data_rw_flags.at(i) = access_write_only;
+   }
+   else {
+    cerr << ERROR_INFO << "Unknown access '" << access << "' of '" << data_names.at(i) << "'." << endl;
+   }
+  }
+ }
+
+ // a shared buffer is read only (write only) if all of its aliases are read only (write only)
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  size_t alias = data_aliases.at(i);
+  if (alias != i && data_rw_flags.at(alias) != data_rw_flags.at(i)) {
+   data_rw_flags.at(alias) = access_read_write;
+  }
+ }
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  data_rw_flags.at(i) = data_rw_flags.at(data_aliases.at(i));
+ }
+
+ vector<bool> data_generated(data_names.size(), false);
+
+ // only a region of an output buffer is stored if a selection is declared
+ vector<H5_Selection> data_selections(data_names.size());
+ vector<bool> data_selected(data_names.size(), false);
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  if (!data_sparse.at(i) && h5_check_selection(data_files.at(i).c_str(), data_names.at(i).c_str())) {
+   if (!h5_is_flat_layout(data_layouts.at(i)) || data_split.at(i) || data_is_image.at(i)) {
+    cerr << ERROR_INFO << "Output selections of vector and compound datasets like '" << data_names.at(i) << "' are not supported." << endl;
+    continue;
+   }
+   data_selected.at(i) = h5_read_selection(data_files.at(i).c_str(), data_names.at(i).c_str(), data_selections.at(i));
+  }
+ }
+
+ // the compression of an output dataset can be declared by its attribute `compression`
+ vector<H5_Compression> data_compression(data_names.size(), global_compression);
+ for (cl_uint i = 0; i < data_names.size(); i++) {
+  if (!data_sparse.at(i) && h5_check_attribute(data_files.at(i).c_str(), data_names.at(i).c_str(), "compression")) {
+   string dataset_compression;
+   h5_read_attribute_string(data_files.at(i).c_str(), data_names.at(i).c_str(), "compression", dataset_compression);
+   if (!h5_parse_compression(dataset_compression, data_compression.at(i))) {
+    data_compression.at(i) = global_compression;
+   }
+  }
+ }
+
+ // host memory for all transfers; blocks are reused for subsequent datasets. A
+ // run without the staging memory of a dataset is aborted (see the loops below).
+ staging_arena staging(dev_mgr.get_context(0), dev_mgr.get_queue(0, 0), huge_pages);
+ auto acquire_staging = [&staging](size_t size) {
+  uint8_t* ptr = staging.acquire(size);
+  if (ptr == nullptr) {
+   throw std::bad_alloc();
+  }
+  return ptr;
+ };
+
+ // fields of a split compound dataset; valid from its first to its last field
+ std::vector<uint8_t*> soa_data;
+
+ std::vector<cl::Memory> data_image_objects(data_names.size());
 
  uint64_t push_time, pull_time;
  push_time = timer.getTimeMicroseconds();
 
  for (cl_uint i = 0; i < data_names.size(); i++) {
   try {
+   // aliases are bound to the buffer created for the first dataset referring to the same object
+   if (data_aliases.at(i) != i) {
+    data_in.push_back(data_in.at(data_aliases.at(i)));
+    data_generated.at(i) = data_generated.at(data_aliases.at(i));
+    data_svm.at(i) = data_svm.at(data_aliases.at(i));
+    for (uint32_t kernel_idx = 0; kernel_idx < found_kernels.size(); kernel_idx++) {
+     cl::Kernel* kernel = dev_mgr.getKernelbyName(0, "ocl_Kernel", found_kernels.at(kernel_idx));
+     if (data_svm.at(i) != nullptr) {
+      svm.set_arg(*kernel, i, data_svm.at(i));
+     }
+     else {
+      kernel->setArg(i, data_in.back());
+     }
+    }
+    continue;
+   }
+
+   // the arguments of sparse matrices have been prepared on the host
+   if (data_sparse.at(i)) {
+    sparse_arguments& arguments = sparse_matrices.at(data_sparse_group.at(i));
+    size_t const arg = data_sparse_arg.at(i);
+    std::vector<uint8_t>& arg_data = arguments.data.at(arg);
+
+    if (arguments.scalars.at(arg)) {
+     // keep the buffer indices in sync with the datasets
+     data_in.push_back(cl::Buffer());
+     for (uint32_t kernel_idx = 0; kernel_idx < found_kernels.size(); kernel_idx++) {
+      dev_mgr.getKernelbyName(0, "ocl_Kernel", found_kernels.at(kernel_idx))->setArg(i, arg_data.size(), arg_data.data());
+     }
+    }
+    else {
+     data_in.push_back(cl::Buffer(dev_mgr.get_context(0), CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, arg_data.size()));
+     dev_mgr.get_queue(0, 0).enqueueWriteBuffer(data_in.back(), CL_TRUE, 0, arg_data.size(), arg_data.data());
+     for (uint32_t kernel_idx = 0; kernel_idx < found_kernels.size(); kernel_idx++) {
+      dev_mgr.getKernelbyName(0, "ocl_Kernel", found_kernels.at(kernel_idx))->setArg(i, data_in.back());
+     }
+     std::vector<uint8_t>().swap(arg_data);
+    }
+    continue;
+   }
+
    uint8_t *tmp_data = nullptr;
-   size_t var_size = 0;
+   H5_Device_Layout const& layout = data_layouts.at(i);
+   size_t var_size = layout.num_elements * layout.element_size;
+
+   // write only buffers are initialized by the kernels and datasets declared
+   // only by their shape and a generator or fill value are initialized on the device
+   data_generator generator;
+   bool generate_buffer = (data_rw_flags.at(i) != access_write_only) && h5_is_flat_layout(layout) && !data_split.at(i) && !data_is_image.at(i)
+                       && check_generator(data_files.at(i).c_str(), data_names.at(i).c_str())
+                       && read_generator(data_files.at(i).c_str(), data_names.at(i).c_str(), generator);
+   bool fill_buffer = (data_rw_flags.at(i) != access_write_only) && h5_is_flat_layout(layout) && !data_split.at(i) && !data_is_image.at(i)
+                   && !generate_buffer
+                   && h5_check_fill_value(data_files.at(i).c_str(), data_names.at(i).c_str());
+   data_generated.at(i) = generate_buffer;
+
+   cl_mem_flags access_flags = CL_MEM_READ_WRITE;
+   if (data_rw_flags.at(i) == access_read_only) {
+    access_flags = CL_MEM_READ_ONLY;
+   }
+   else if (data_rw_flags.at(i) == access_write_only) {
+    access_flags = CL_MEM_WRITE_ONLY;
+   }
 
-   switch (data_types.at(i)) {
-   case H5_float:
-    var_size = data_sizes.at(i) * sizeof(float);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<float>(filename, data_names.at(i).c_str(), (float*)tmp_data);
-    break;
-   case H5_double:
-    var_size = data_sizes.at(i) * sizeof(double);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<double>(filename, data_names.at(i).c_str(), (double*)tmp_data);
-    break;
-   case H5_char:
-    var_size = data_sizes.at(i) * sizeof(cl_char);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<cl_char>(filename, data_names.at(i).c_str(), (cl_char*)tmp_data);
-    break;
-   case H5_uchar:
-    var_size = data_sizes.at(i) * sizeof(cl_uchar);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<cl_uchar>(filename, data_names.at(i).c_str(), (cl_uchar*)tmp_data);
-    break;
-   case H5_short:
-    var_size = data_sizes.at(i) * sizeof(cl_short);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<cl_short>(filename, data_names.at(i).c_str(), (cl_short*)tmp_data);
-    break;
-   case H5_ushort:
-    var_size = data_sizes.at(i) * sizeof(cl_ushort);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<cl_ushort>(filename, data_names.at(i).c_str(), (cl_ushort*)tmp_data);
-    break;
-   case H5_int:
-    var_size = data_sizes.at(i) * sizeof(cl_int);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<cl_int>(filename, data_names.at(i).c_str(), (cl_int*)tmp_data);
-    break;
-   case H5_uint:
-    var_size = data_sizes.at(i) * sizeof(cl_uint);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<cl_uint>(filename, data_names.at(i).c_str(), (cl_uint*)tmp_data);
-    break;
-   case H5_long:
-    var_size = data_sizes.at(i) * sizeof(cl_long);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<cl_long>(filename, data_names.at(i).c_str(), (cl_long*)tmp_data);
-    break;
-   case H5_ulong:
-    var_size = data_sizes.at(i) * sizeof(cl_ulong);
-    tmp_data = new uint8_t[var_size];
-    h5_read_buffer<cl_ulong>(filename, data_names.at(i).c_str(), (cl_ulong*)tmp_data);
-    break;
-   default:
-    cerr << ERROR_INFO << "Data type '" << data_types.at(i) << "' unknown." << endl;
-    break;
+   // in SVM mode, the input data are read directly into the shared memory of the buffer
+   uint8_t *svm_data = nullptr;
+   cl::Buffer svm_buffer;
+   if (use_svm && !data_split.at(i) && !data_is_image.at(i)) {
+    svm_data = (uint8_t*)svm.allocate(var_size, access_flags, svm_buffer);
+    data_svm.at(i) = svm_data;
+    if ((data_rw_flags.at(i) != access_write_only) && !generate_buffer && !fill_buffer) {
+     svm.map(svm_data, var_size, CL_MAP_WRITE_INVALIDATE_REGION);
+    }
    }
 
-   switch (data_rw_flags.at(i)) {
-   case 0:
-    data_in.push_back(cl::Buffer(dev_mgr.get_context(0), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, var_size));
-    dev_mgr.get_queue(0, 0).enqueueWriteBuffer(data_in.back(), blocking, 0, var_size, tmp_data);
-    break;
-   case 1:
-    data_in.push_back(cl::Buffer(dev_mgr.get_context(0), CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, var_size));
+   // datasets stored contiguously without filters are transferred directly from
+   // a mapping of the input file instead of staging memory
+   uint8_t *mapped_data = nullptr;
+   std::string raw_filename;
+   size_t raw_offset = 0, raw_size = 0;
+   if ((data_rw_flags.at(i) != access_write_only) && !generate_buffer && !fill_buffer && svm_data == nullptr
+       && h5_is_flat_layout(layout) && !data_split.at(i) && !data_is_image.at(i) && data_types.at(i) == data_storage_types.at(i)
+       && h5_get_raw_data_offset(data_files.at(i).c_str(), data_names.at(i).c_str(), raw_filename, raw_offset, raw_size)
+       && raw_size == var_size) {
+    mapped_data = mapped_files.map(raw_filename.c_str(), raw_offset, raw_size);
+   }
+   // on CPU devices, read only buffers use the mapped data as their memory
+   bool use_mapping = (mapped_data != nullptr) && cpu_device && (data_rw_flags.at(i) == access_read_only)
+                   && ((uintptr_t)mapped_data % base_alignment == 0);
+
+   if (mapped_data != nullptr) {
+    tmp_data = mapped_data;
+   }
+   else if (data_split.at(i)) {
+    H5_Soa_Layout const& soa = soa_layouts.at(data_soa_group.at(i));
+    size_t const field = data_soa_field.at(i);
+    size_t const first = i - field;
+    size_t const num_records = data_sizes.at(i) / soa.lanes.at(field);
+
+    // the records are read once and transposed into the buffers of all fields
+    if (field == 0) {
+     bool read_records = false;
+     for (size_t idx = first; idx < first + soa.fields.size(); idx++) {
+      read_records = read_records || (data_rw_flags.at(idx) != access_write_only);
+     }
+     soa_data.assign(soa.fields.size(), nullptr);
+     if (read_records) {
+      std::vector<size_t> field_sizes(soa.fields.size());
+      for (size_t idx = 0; idx < soa.fields.size(); idx++) {
+       field_sizes.at(idx) = soa.lanes.at(idx) * get_type_size(soa.types.at(idx));
+       soa_data.at(idx) = acquire_staging(num_records * field_sizes.at(idx));
+      }
+      uint8_t *records = acquire_staging(num_records * soa.record_size);
+      h5_read_device_buffer(data_files.at(i).c_str(), data_names.at(i).c_str(), H5_Device_Layout{num_records, 1, soa.record_size, soa.mem_type}, records);
+      aos_to_soa(records, num_records, soa.record_size, soa.offsets, field_sizes, soa_data);
+      staging.release(records);
+     }
+    }
+
+    tmp_data = soa_data.at(field);
+    soa_data.at(field) = nullptr;
+    if (tmp_data != nullptr && data_rw_flags.at(i) == access_write_only) {
+     staging.release(tmp_data); tmp_data = nullptr;
+    }
+   }
+   else if ((data_rw_flags.at(i) != access_write_only) && !generate_buffer && !fill_buffer && !h5_is_flat_layout(layout)) {
+    tmp_data = (svm_data != nullptr) ? svm_data : acquire_staging(var_size);
+    h5_read_device_buffer(data_files.at(i).c_str(), data_names.at(i).c_str(), layout, tmp_data);
+   }
+   else if ((data_rw_flags.at(i) != access_write_only) && !generate_buffer && !fill_buffer
+            && data_types.at(i) != data_storage_types.at(i)) {
+    size_t storage_type_size = get_type_size(data_storage_types.at(i));
+    uint8_t *stored_data = acquire_staging(data_sizes.at(i) * storage_type_size);
+    h5_read_device_buffer(data_files.at(i).c_str(), data_names.at(i).c_str(), H5_Device_Layout{data_sizes.at(i), 1, storage_type_size, {}}, stored_data);
+
+    tmp_data = (svm_data != nullptr) ? svm_data : acquire_staging(var_size);
+    convert_buffer(stored_data, data_storage_types.at(i), tmp_data, data_types.at(i), data_sizes.at(i));
+    staging.release(stored_data);
+   }
+   else if ((data_rw_flags.at(i) != access_write_only) && !generate_buffer && !fill_buffer) {
+    tmp_data = (svm_data != nullptr) ? svm_data : acquire_staging(var_size);
+
+    switch (data_types.at(i)) {
+    case H5_float:
+     h5_read_buffer<float>(data_files.at(i).c_str(), data_names.at(i).c_str(), (float*)tmp_data);
+     break;
+    case H5_double:
+     h5_read_buffer<double>(data_files.at(i).c_str(), data_names.at(i).c_str(), (double*)tmp_data);
+     break;
+    case H5_char:
+     h5_read_buffer<cl_char>(data_files.at(i).c_str(), data_names.at(i).c_str(), (cl_char*)tmp_data);
+     break;
+    case H5_uchar:
+     h5_read_buffer<cl_uchar>(data_files.at(i).c_str(), data_names.at(i).c_str(), (cl_uchar*)tmp_data);
+     break;
+    case H5_short:
+     h5_read_buffer<cl_short>(data_files.at(i).c_str(), data_names.at(i).c_str(), (cl_short*)tmp_data);
+     break;
+    case H5_ushort:
+     h5_read_buffer<cl_ushort>(data_files.at(i).c_str(), data_names.at(i).c_str(), (cl_ushort*)tmp_data);
+     break;
+    case H5_int:
+     h5_read_buffer<cl_int>(data_files.at(i).c_str(), data_names.at(i).c_str(), (cl_int*)tmp_data);
+     break;
+    case H5_uint:
+     h5_read_buffer<cl_uint>(data_files.at(i).c_str(), data_names.at(i).c_str(), (cl_uint*)tmp_data);
+     break;
+    case H5_long:
+     h5_read_buffer<cl_long>(data_files.at(i).c_str(), data_names.at(i).c_str(), (cl_long*)tmp_data);
+     break;
+    case H5_ulong:
+     h5_read_buffer<cl_ulong>(data_files.at(i).c_str(), data_names.at(i).c_str(), (cl_ulong*)tmp_data);
+     break;
+    case H5_half:
+     h5_read_device_buffer(data_files.at(i).c_str(), data_names.at(i).c_str(), layout, tmp_data);
+     break;
+    default:
+     cerr << ERROR_INFO << "Data type '" << data_types.at(i) << "' unknown." << endl;
+     break;
+    }
+   }
+
+   if (tmp_data != nullptr && tmp_data == svm_data) {
+    svm.unmap(svm_data);
+   }
+
+   if (data_is_image.at(i)) {
+    data_image_objects.at(i) = create_image(dev_mgr.get_context(0), dev_mgr.get_queue(0, 0), access_flags, data_images.at(i), tmp_data);
+    // keep the buffer indices in sync with the datasets
+    data_in.push_back(cl::Buffer());
+
+    for (uint32_t kernel_idx = 0; kernel_idx < found_kernels.size(); kernel_idx++) {
+     dev_mgr.getKernelbyName(0, "ocl_Kernel", found_kernels.at(kernel_idx))->setArg(i, data_image_objects.at(i));
+    }
+
+    if (tmp_data != nullptr) {
+     staging.release(tmp_data); tmp_data = nullptr;
+    }
+    continue;
+   }
+
+   if (svm_data != nullptr) {
+    data_in.push_back(svm_buffer);
+   }
+   else if (use_mapping) {
+    data_in.push_back(cl::Buffer(dev_mgr.get_context(0), access_flags | CL_MEM_USE_HOST_PTR, var_size, mapped_data));
+   }
+   else {
+    data_in.push_back(cl::Buffer(dev_mgr.get_context(0), access_flags | CL_MEM_ALLOC_HOST_PTR, var_size));
+   }
+
+   if (generate_buffer) {
+    run_generator(dev_mgr, generator, data_types.at(i), data_in.back(), data_sizes.at(i));
+   }
+   else if (fill_buffer) {
+    // the pattern is a single element of the buffer's type (at most a cl_ulong)
+    cl_ulong pattern = 0;
+    h5_read_fill_value(data_files.at(i).c_str(), data_names.at(i).c_str(), data_types.at(i), &pattern);
+    cl_int err = clEnqueueFillBuffer(dev_mgr.get_queue(0, 0)(), data_in.back()(), &pattern, get_type_size(data_types.at(i)),
+                                     0, var_size, 0, NULL, NULL);
+    if (err != CL_SUCCESS) {
+     throw cl::Error(err, "clEnqueueFillBuffer");
+    }
+   }
+   else if (tmp_data != nullptr && tmp_data != svm_data && !use_mapping) {
     dev_mgr.get_queue(0, 0).enqueueWriteBuffer(data_in.back(), blocking, 0, var_size, tmp_data);
-    break;
-   case 2:
-    data_in.push_back(cl::Buffer(dev_mgr.get_context(0), CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR, var_size));
-    break;
    }
 
    for (uint32_t kernel_idx = 0; kernel_idx < found_kernels.size(); kernel_idx++) {
-    dev_mgr.getKernelbyName(0, "ocl_Kernel", found_kernels.at(kernel_idx))->setArg(i, data_in.back());
+    cl::Kernel* kernel = dev_mgr.getKernelbyName(0, "ocl_Kernel", found_kernels.at(kernel_idx));
+    if (svm_data != nullptr) {
+     svm.set_arg(*kernel, i, svm_data);
+    }
+    else {
+     kernel->setArg(i, data_in.back());
+    }
    }
 
-   if (tmp_data != nullptr) {
-    delete[] tmp_data; tmp_data = nullptr;
+   // mappings used by buffers are kept; others are unmapped once they have been transferred
+   if (tmp_data != nullptr && tmp_data == mapped_data) {
+    if (!use_mapping && blocking) {
+     mapped_files.unmap(mapped_data);
+    }
+    tmp_data = nullptr;
+   }
+   if (tmp_data != nullptr && tmp_data != svm_data) {
+    staging.release(tmp_data); tmp_data = nullptr;
    }
   }
   catch (cl::Error err) {
    std::cerr << ERROR_INFO << "Exception: " << err.what() << std::endl;
   }
+  catch (std::bad_alloc const&) {
+   std::cerr << ERROR_INFO << "No staging memory for reading dataset '" << data_names.at(i) << "'." << std::endl;
+   return -1;
+  }
  }
 
  dev_mgr.get_queue(0, 0).finish(); // Buffer Copy is asynchronous
@@ -1383,59 +2216,207 @@ int main(int argc, char *argv[]) {
 
  for (cl_uint i = 0; i < data_names.size(); i++) {
   try {
-   uint8_t *tmp_data = nullptr;
-   size_t var_size = 0;
+   // sparse matrices are not changed by the kernels; the group is taken from the input file
+   if (data_sparse.at(i)) {
+    if (data_sparse_arg.at(i) == 0) {
+     store_input(data_names.at(i), data_files.at(i));
+    }
+    buffer_counter++;
+    continue;
+   }
+
+   h5_set_compression(data_compression.at(i));
+
+   // fields of split compound datasets are interleaved again after the last field has been read
+   if (data_split.at(i)) {
+    H5_Soa_Layout const& soa = soa_layouts.at(data_soa_group.at(i));
+    size_t const field = data_soa_field.at(i);
+    size_t const first = i - field;
+    size_t const num_records = data_sizes.at(i) / soa.lanes.at(field);
 
-   switch (data_types.at(i)) {
-    case H5_float: var_size = data_sizes.at(i) * sizeof(cl_float); break;
-    case H5_double: var_size = data_sizes.at(i) * sizeof(cl_double); break;
-    case H5_char:  var_size = data_sizes.at(i) * sizeof(cl_char);  break;
-    case H5_uchar: var_size = data_sizes.at(i) * sizeof(cl_uchar); break;
-    case H5_short: var_size = data_sizes.at(i) * sizeof(cl_short); break;
-    case H5_ushort: var_size = data_sizes.at(i) * sizeof(cl_ushort); break;
-    case H5_int:  var_size = data_sizes.at(i) * sizeof(cl_int);  break;
-    case H5_uint:  var_size = data_sizes.at(i) * sizeof(cl_uint);  break;
-    case H5_long:  var_size = data_sizes.at(i) * sizeof(cl_long);  break;
-    case H5_ulong: var_size = data_sizes.at(i) * sizeof(cl_ulong); break;
-    default: cerr << ERROR_INFO << "Data type '" << data_types.at(i) << "' unknown." << endl;
+    bool read_only = true;
+    for (size_t idx = first; idx < first + soa.fields.size(); idx++) {
+     read_only = read_only && (data_rw_flags.at(idx) == access_read_only);
+    }
+    if (read_only) {
+     if (field == 0) {
+      store_input(data_names.at(i), data_files.at(i));
+     }
+     buffer_counter++;
+     continue;
+    }
+
+    if (field == 0) {
+     soa_data.assign(soa.fields.size(), nullptr);
+    }
+    size_t var_size = data_layouts.at(i).num_elements * data_layouts.at(i).element_size;
+    soa_data.at(field) = acquire_staging(var_size);
+    dev_mgr.get_queue(0, 0).enqueueReadBuffer(data_in.at(buffer_counter), blocking, 0, var_size, soa_data.at(field));
+    buffer_counter++;
+
+    if (field + 1 == soa.fields.size()) {
+     dev_mgr.get_queue(0, 0).finish(); //Buffer Copy is asynchronous
+
+     std::vector<size_t> field_sizes(soa.fields.size());
+     for (size_t idx = 0; idx < soa.fields.size(); idx++) {
+      field_sizes.at(idx) = soa.lanes.at(idx) * get_type_size(soa.types.at(idx));
+     }
+     uint8_t *records = acquire_staging(num_records * soa.record_size);
+     soa_to_aos(std::vector<uint8_t const*>(soa_data.begin(), soa_data.end()), num_records, soa.record_size,
+                soa.offsets, field_sizes, records);
+     output->write_device_buffer(data_names.at(i).c_str(), H5_Device_Layout{num_records, 1, soa.record_size, soa.mem_type},
+                                 H5_compound, records, data_dims.at(i), data_chunks.at(i));
+     staging.release(records);
+
+     for (uint8_t *ptr : soa_data) {
+      staging.release(ptr);
+     }
+     soa_data.clear();
+    }
+    continue;
+   }
+
+   // read only buffers are unchanged; the input data are stored instead of downloading them.
+   // Generated read only buffers are not stored; they are defined by the input file.
+   if (data_rw_flags.at(buffer_counter) == access_read_only) {
+    if (!data_generated.at(i)) {
+     store_input(data_names.at(i), data_files.at(i));
+    }
+    buffer_counter++;
+    continue;
+   }
+
+   // aliases are stored only once, as in the input file
+   if (data_aliases.at(i) != i) {
+    output->link_alias(data_names.at(i).c_str(), data_names.at(data_aliases.at(i)).c_str());
+    buffer_counter++;
+    continue;
    }
 
-   tmp_data = new uint8_t[var_size];
+   uint8_t *tmp_data = nullptr;
+   H5_Device_Layout const& layout = data_layouts.at(i);
+   size_t var_size = layout.num_elements * layout.element_size;
+
+   if (data_selected.at(i)) {
+    H5_Selection const& selection = data_selections.at(i);
+    size_t const rank = selection.dims.size();
+    size_t const type_size = get_type_size(data_types.at(i));
+
+    // empty selections are not stored at all
+    size_t num_selected = accumulate(selection.count.begin(), selection.count.end(), (size_t)1, multiplies<size_t>());
+    if (num_selected == 0) {
+     buffer_counter++;
+     continue;
+    }
+
+    // Only the bounding box of the selection is transferred from the device.
+    // OpenCL orders the dimensions starting with the fastest varying one.
+    vector<size_t> box_dims(rank);
+    cl::array<cl::size_type, 3> buffer_origin = {{0, 0, 0}};
+    cl::array<cl::size_type, 3> host_origin = {{0, 0, 0}};
+    cl::array<cl::size_type, 3> region = {{1, 1, 1}};
+    size_t buffer_extent[3] = {1, 1, 1};
+    for (size_t dim = 0; dim < rank; dim++) {
+     size_t ocl_dim = rank - 1 - dim;
+     box_dims.at(dim) = (selection.count.at(dim) - 1) * selection.stride.at(dim) + 1;
+     buffer_origin[ocl_dim] = selection.offset.at(dim);
+     region[ocl_dim] = box_dims.at(dim);
+     buffer_extent[ocl_dim] = selection.dims.at(dim);
+    }
+    buffer_origin[0] *= type_size;
+    region[0] *= type_size;
+
+    size_t buffer_row_pitch = buffer_extent[0] * type_size;
+    size_t buffer_slice_pitch = buffer_row_pitch * buffer_extent[1];
+    size_t host_row_pitch = region[0];
+    size_t host_slice_pitch = host_row_pitch * region[1];
+
+    tmp_data = acquire_staging(host_slice_pitch * region[2]);
+
+    dev_mgr.get_queue(0, 0).enqueueReadBufferRect(data_in.at(buffer_counter), blocking, buffer_origin, host_origin, region,
+                                                  buffer_row_pitch, buffer_slice_pitch, host_row_pitch, host_slice_pitch, tmp_data);
 
-   switch (data_rw_flags.at(buffer_counter)) {
-    case 0: dev_mgr.get_queue(0, 0).enqueueReadBuffer(data_in.at(buffer_counter), blocking, 0, var_size, tmp_data); break;
-    case 1: break;
-    case 2: dev_mgr.get_queue(0, 0).enqueueReadBuffer(data_in.at(buffer_counter), blocking, 0, var_size, tmp_data); break;
+    dev_mgr.get_queue(0, 0).finish(); //Buffer Copy is asynchronous
+
+    // results are stored using the type of the input dataset
+    if (data_types.at(i) != data_storage_types.at(i)) {
+     size_t num_box = host_slice_pitch * region[2] / type_size;
+     uint8_t *stored_data = acquire_staging(num_box * get_type_size(data_storage_types.at(i)));
+     convert_buffer(tmp_data, data_types.at(i), stored_data, data_storage_types.at(i), num_box);
+     staging.release(tmp_data);
+     tmp_data = stored_data;
+    }
+
+    output->write_selection(data_names.at(i).c_str(), data_storage_types.at(i), tmp_data, box_dims, selection.stride, selection.count,
+                            data_chunks.at(i));
+
+    staging.release(tmp_data); tmp_data = nullptr;
+    buffer_counter++;
+    continue;
+   }
+
+   // in SVM mode, the results are written directly from the shared memory
+   uint8_t *svm_data = (uint8_t*)data_svm.at(i);
+   if (svm_data != nullptr) {
+    svm.map(svm_data, var_size, CL_MAP_READ);
+    tmp_data = svm_data;
+   }
+   else if (data_is_image.at(i)) {
+    tmp_data = acquire_staging(var_size);
+    read_image_data(dev_mgr.get_queue(0, 0), data_image_objects.at(i), data_images.at(i), tmp_data);
+   }
+   else {
+    tmp_data = acquire_staging(var_size);
+    dev_mgr.get_queue(0, 0).enqueueReadBuffer(data_in.at(buffer_counter), blocking, 0, var_size, tmp_data);
    }
 
    dev_mgr.get_queue(0, 0).finish(); //Buffer Copy is asynchronous
 
-   switch (data_types.at(i)) {
-    case H5_float: h5_write_buffer<float>(  out_name, data_names.at(i).c_str(), (float*)tmp_data,   data_sizes.at(buffer_counter)); break;
-    case H5_double: h5_write_buffer<double>(  out_name, data_names.at(i).c_str(), (double*)tmp_data,  data_sizes.at(buffer_counter)); break;
-    case H5_char:  h5_write_buffer<cl_char>( out_name, data_names.at(i).c_str(), (cl_char*)tmp_data,  data_sizes.at(buffer_counter)); break;
-    case H5_uchar: h5_write_buffer<cl_uchar>( out_name, data_names.at(i).c_str(), (cl_uchar*)tmp_data, data_sizes.at(buffer_counter)); break;
-    case H5_short: h5_write_buffer<cl_short>( out_name, data_names.at(i).c_str(), (cl_short*)tmp_data, data_sizes.at(buffer_counter)); break;
-    case H5_ushort: h5_write_buffer<cl_ushort>(out_name, data_names.at(i).c_str(), (cl_ushort*)tmp_data, data_sizes.at(buffer_counter)); break;
-    case H5_int:  h5_write_buffer<cl_int>(  out_name, data_names.at(i).c_str(), (cl_int*)tmp_data,  data_sizes.at(buffer_counter)); break;
-    case H5_uint:  h5_write_buffer<cl_uint>( out_name, data_names.at(i).c_str(), (cl_uint*)tmp_data,  data_sizes.at(buffer_counter)); break;
-    case H5_long:  h5_write_buffer<cl_long>( out_name, data_names.at(i).c_str(), (cl_long*)tmp_data,  data_sizes.at(buffer_counter)); break;
-    case H5_ulong: h5_write_buffer<cl_ulong>( out_name, data_names.at(i).c_str(), (cl_ulong*)tmp_data, data_sizes.at(buffer_counter)); break;
-    default: cerr << ERROR_INFO << "Data type '" << data_types.at(i) << "' unknown." << endl;
-   }
-   if (tmp_data != nullptr) {
-    delete[] tmp_data; tmp_data = nullptr;
+   // results are stored using the type of the input dataset
+   if (data_types.at(i) != data_storage_types.at(i)) {
+    uint8_t *stored_data = acquire_staging(data_sizes.at(i) * get_type_size(data_storage_types.at(i)));
+    convert_buffer(tmp_data, data_types.at(i), stored_data, data_storage_types.at(i), data_sizes.at(i));
+    if (tmp_data != svm_data) {
+     staging.release(tmp_data);
+    }
+    tmp_data = stored_data;
+   }
+
+   if (!h5_is_flat_layout(layout)) {
+    output->write_device_buffer(data_names.at(i).c_str(), layout, data_types.at(i), tmp_data, data_dims.at(i), data_chunks.at(i));
+   }
+   else {
+    output->write_buffer(data_names.at(i).c_str(), data_storage_types.at(i), tmp_data, data_dims.at(i), data_chunks.at(i));
+   }
+   if (svm_data != nullptr) {
+    svm.unmap(svm_data);
+   }
+   if (tmp_data != nullptr && tmp_data != svm_data) {
+    staging.release(tmp_data); tmp_data = nullptr;
    }
    buffer_counter++;
   }
   catch (cl::Error err) {
    std::cerr << ERROR_INFO << "Exception: " << err.what() << std::endl;
   }
+  catch (std::bad_alloc const&) {
+   std::cerr << ERROR_INFO << "No staging memory for storing dataset '" << data_names.at(i) << "'." << std::endl;
+   return -1;
+  }
  }
 
+ h5_set_compression(global_compression);
+ output_file.flush();
  pull_time = timer.getTimeMicroseconds() - pull_time;
  h5_write_single<double>(out_name, "housekeeping/data_store_time", 1.e-6 * pull_time,
              "Time in seconds of the data transfer: device -> host -> hdf5 output file.");
+ h5_write_single<cl_ulong>(out_name, "housekeeping/staging_memory", staging.high_water_mark(),
+             "Maximal size in bytes of the host memory used for data transfers.");
+
+ if (use_cache) {
+  output_file.flush();
+  result_cache(cache_dir).store(cache_key, out_name);
+ }
 
  return 0;
 }
\ No newline at end of file
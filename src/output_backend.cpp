@@ -0,0 +1,310 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "output_backend.hpp"
+
+
+hdf5_output::hdf5_output(std::string const& filename, size_t shard_size)
+  : filename(filename), shard_size(shard_size)
+{
+}
+
+bool hdf5_output::write_buffer(char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims)
+{
+  size_t num_elements = 1;
+  for (size_t dim : dims) {
+    num_elements *= dim;
+  }
+  if (shard_size > 0 && num_elements * get_type_size(type) > shard_size && !dims.empty()) {
+    return h5_write_shards(filename, varname, type, data, dims, chunk_dims, shard_size);
+  }
+
+  switch (type) {
+    case H5_float:  return h5_write_buffer<float>(    filename, varname, (float const*)data,     dims, chunk_dims);
+    case H5_double: return h5_write_buffer<double>(   filename, varname, (double const*)data,    dims, chunk_dims);
+    case H5_char:   return h5_write_buffer<cl_char>(  filename, varname, (cl_char const*)data,   dims, chunk_dims);
+    case H5_uchar:  return h5_write_buffer<cl_uchar>( filename, varname, (cl_uchar const*)data,  dims, chunk_dims);
+    case H5_short:  return h5_write_buffer<cl_short>( filename, varname, (cl_short const*)data,  dims, chunk_dims);
+    case H5_ushort: return h5_write_buffer<cl_ushort>(filename, varname, (cl_ushort const*)data, dims, chunk_dims);
+    case H5_int:    return h5_write_buffer<cl_int>(   filename, varname, (cl_int const*)data,    dims, chunk_dims);
+    case H5_uint:   return h5_write_buffer<cl_uint>(  filename, varname, (cl_uint const*)data,   dims, chunk_dims);
+    case H5_long:   return h5_write_buffer<cl_long>(  filename, varname, (cl_long const*)data,   dims, chunk_dims);
+    case H5_ulong:  return h5_write_buffer<cl_ulong>( filename, varname, (cl_ulong const*)data,  dims, chunk_dims);
+    case H5_half:   return h5_write_device_buffer(filename, varname, H5_Device_Layout{num_elements, 1, get_type_size(type), {}},
+                                                  type, data, dims, chunk_dims);
+    default: std::cerr << ERROR_INFO << "Data type '" << type << "' unknown." << std::endl;
+  }
+  return false;
+}
+
+bool hdf5_output::write_device_buffer(char const* varname, H5_Device_Layout const& layout, HD5_Type type, void const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims)
+{
+  return h5_write_device_buffer(filename, varname, layout, type, data, dims, chunk_dims);
+}
+
+bool hdf5_output::write_selection(char const* varname, HD5_Type type, void const* data, std::vector<size_t> const& mem_dims,
+  std::vector<size_t> const& stride, std::vector<size_t> const& count, std::vector<size_t> const& chunk_dims)
+{
+  return h5_write_selection(filename, varname, type, data, mem_dims, stride, count, chunk_dims);
+}
+
+bool hdf5_output::copy_input(char const* varname, char const* input_filename)
+{
+  return h5_copy_object(filename, varname, input_filename, varname);
+}
+
+bool hdf5_output::link_input(char const* varname, char const* input_filename)
+{
+  // by absolute path, so that the link does not depend on the working directory of the reader
+  return h5_create_external_link(filename, varname, h5_absolute_path(input_filename).c_str(), varname);
+}
+
+bool hdf5_output::link_alias(char const* varname, char const* target_varname)
+{
+  return h5_create_hard_link(filename, varname, target_varname);
+}
+
+
+// the data of .npy files start at a multiple of the page size, so that they can
+// be written directly from page aligned memory
+static const size_t npy_alignment = 4096;
+static const size_t npy_block_size = 64 * 1024 * 1024;
+
+// type of the elements in the notation of NumPy, e.g. "<f4"; empty for structs
+static std::string npy_descr(HD5_Type type)
+{
+  uint16_t probe = 1;
+  char order = (*(uint8_t*)&probe == 1) ? '<' : '>';
+
+  switch (type) {
+    case H5_float:  return std::string(1, order) + "f4";
+    case H5_double: return std::string(1, order) + "f8";
+    case H5_char:   return "|i1";
+    case H5_uchar:  return "|u1";
+    case H5_short:  return std::string(1, order) + "i2";
+    case H5_ushort: return std::string(1, order) + "u2";
+    case H5_int:    return std::string(1, order) + "i4";
+    case H5_uint:   return std::string(1, order) + "u4";
+    case H5_long:   return std::string(1, order) + "i8";
+    case H5_ulong:  return std::string(1, order) + "u8";
+    case H5_half:   return std::string(1, order) + "f2";
+    default:        return "";
+  }
+}
+
+// header of version 1.0 padded with spaces to `npy_alignment` bytes
+static std::string npy_header(std::string const& descr, std::vector<size_t> const& dims)
+{
+  std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+  for (size_t dim = 0; dim < dims.size(); ++dim) {
+    dict += (dim > 0 ? ", " : "") + std::to_string(dims.at(dim));
+  }
+  dict += (dims.size() == 1) ? ",), }" : "), }";
+
+  size_t header_size = ((10 + dict.size() + 1 + npy_alignment - 1) / npy_alignment) * npy_alignment;
+  size_t header_len = header_size - 10;
+  std::string header("\x93NUMPY\x01\x00", 8);
+  header += (char)(header_len & 0xFF);
+  header += (char)(header_len >> 8);
+  header += dict;
+  header.append(header_size - header.size() - 1, ' ');
+  header += '\n';
+  return header;
+}
+
+#if !defined(_WIN32)
+static bool pwrite_all(int fd, uint8_t const* data, size_t size, size_t offset)
+{
+  while (size > 0) {
+    ssize_t written = pwrite(fd, data, std::min(size, npy_block_size), (off_t)offset);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+#endif
+
+// write the header followed by the data; with `direct_io`, the aligned part of
+// the data bypasses the page cache if the file system supports it
+static bool write_npy_file(std::string const& path, std::string const& header, void const* data, size_t size, bool direct_io)
+{
+#if defined(_WIN32)
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(header.data(), header.size());
+  file.write((char const*)data, size);
+  return file.good();
+#else
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  bool success = pwrite_all(fd, (uint8_t const*)header.data(), header.size(), 0);
+
+  size_t written = 0;
+#if defined(O_DIRECT)
+  if (success && direct_io && (uintptr_t)data % npy_alignment == 0) {
+    int direct_fd = open(path.c_str(), O_WRONLY | O_DIRECT);
+    if (direct_fd >= 0) {
+      size_t aligned_size = size - size % npy_alignment;
+      if (pwrite_all(direct_fd, (uint8_t const*)data, aligned_size, header.size())) {
+        written = aligned_size;
+      }
+      close(direct_fd);
+    }
+  }
+#endif
+  success = success && pwrite_all(fd, (uint8_t const*)data + written, size - written, header.size() + written);
+  success = (close(fd) == 0) && success;
+  return success;
+#endif
+}
+
+
+npy_output::npy_output(std::string const& filename, bool direct_io)
+  : hdf5_output(filename), direct_io(direct_io)
+{
+}
+
+bool npy_output::write_buffer(char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims)
+{
+  std::string descr = npy_descr(type);
+  if (descr.empty()) {
+    return hdf5_output::write_buffer(varname, type, data, dims, chunk_dims);
+  }
+
+  std::string directory, name;
+  h5_sidecar_name(filename.c_str(), varname, directory, name);
+  name += ".npy";
+
+  size_t size = get_type_size(type);
+  for (size_t dim : dims) {
+    size *= dim;
+  }
+  std::string header = npy_header(descr, dims);
+  if (!write_npy_file(directory + name, header, data, size, direct_io)) {
+    std::cerr << ERROR_INFO << "Writing variable '" << varname << "' to file '" << directory + name << "' not possible." << std::endl;
+    return false;
+  }
+
+  // the name is relative to the output file (see `h5_create_external_dataset`)
+  return h5_create_external_dataset(filename, varname, type, dims, name.c_str(), header.size());
+}
+
+
+shm_output::shm_output(std::string const& filename, bool replace_segments)
+  : hdf5_output(filename)
+{
+#if defined(__linux__)
+  // the segments are listed in /dev/shm; their names start with the name of
+  // the output file, given as sidecar name of an empty dataset name
+  if (replace_segments) {
+    std::string directory, prefix;
+    h5_sidecar_name(filename.c_str(), "", directory, prefix);
+    DIR* dir = opendir("/dev/shm");
+    if (dir != nullptr) {
+      for (dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+        std::string name(entry->d_name);
+        if (name.compare(0, prefix.size(), prefix) == 0) {
+          shm_unlink(("/" + name).c_str());
+        }
+      }
+      closedir(dir);
+    }
+  }
+#endif
+}
+
+bool shm_output::write_buffer(char const* varname, HD5_Type type, void const* data,
+  std::vector<size_t> const& dims, std::vector<size_t> const& chunk_dims)
+{
+  std::string descr = npy_descr(type);
+  if (descr.empty()) {
+    return hdf5_output::write_buffer(varname, type, data, dims, chunk_dims);
+  }
+
+  std::string directory, name;
+  h5_sidecar_name(filename.c_str(), varname, directory, name);
+  std::string segment = "/" + name;
+
+  size_t size = get_type_size(type);
+  std::string shape = "(";
+  for (size_t dim = 0; dim < dims.size(); ++dim) {
+    size *= dims.at(dim);
+    shape += (dim > 0 ? ", " : "") + std::to_string(dims.at(dim));
+  }
+  shape += (dims.size() == 1) ? ",)" : ")";
+  std::string header = npy_header(descr, dims);
+
+  bool success = false;
+#if !defined(_WIN32)
+  int fd = shm_open(segment.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+  if (fd >= 0) {
+    void* ptr = MAP_FAILED;
+    if (ftruncate(fd, header.size() + size) == 0) {
+      ptr = mmap(NULL, header.size() + size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (ptr != MAP_FAILED) {
+      memcpy(ptr, header.data(), header.size());
+      memcpy((uint8_t*)ptr + header.size(), data, size);
+      munmap(ptr, header.size() + size);
+      success = true;
+    }
+    else {
+      shm_unlink(segment.c_str());
+    }
+  }
+#endif
+  if (!success) {
+    std::cerr << ERROR_INFO << "Writing variable '" << varname << "' to shared memory segment '" << segment << "' not possible." << std::endl;
+    return false;
+  }
+
+  return h5_write_string(filename, varname, segment)
+      && h5_write_attribute_string(filename, varname, "dtype", descr)
+      && h5_write_attribute_string(filename, varname, "shape", shape);
+}
+
+
+std::unique_ptr<output_backend> create_output_backend(std::string const& format, std::string const& filename, size_t shard_size)
+{
+  if (format == "hdf5") {
+    return std::unique_ptr<output_backend>(new hdf5_output(filename, shard_size));
+  }
+  if (format == "npy" || format == "npy:direct") {
+    return std::unique_ptr<output_backend>(new npy_output(filename, format == "npy:direct"));
+  }
+#if !defined(_WIN32)
+  if (format == "shm" || format == "shm:replace" || format == "shm:keep") {
+    return std::unique_ptr<output_backend>(new shm_output(filename, format != "shm:keep"));
+  }
+#endif
+
+  std::cerr << ERROR_INFO << "Output format '" << format << "' unknown; use 'hdf5', 'npy', 'npy:direct', 'shm', or 'shm:keep'." << std::endl;
+  return nullptr;
+}
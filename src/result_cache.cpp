@@ -0,0 +1,202 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <direct.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "util.hpp"
+#include "result_cache.hpp"
+
+
+// copy `filename` to `copy_name`, sharing the blocks of the file (reflink) if the
+// file system supports it. Entries and output files are never hard links, since
+// modifying an output file in place would modify the entry as well.
+static bool copy_file(std::string const& filename, std::string const& copy_name)
+{
+#if defined(__linux__) && defined(FICLONE)
+  int source_fd = open(filename.c_str(), O_RDONLY);
+  if (source_fd >= 0) {
+    int target_fd = open(copy_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool cloned = target_fd >= 0 && ioctl(target_fd, FICLONE, source_fd) == 0;
+    if (target_fd >= 0) {
+      cloned = (close(target_fd) == 0) && cloned;
+    }
+    close(source_fd);
+    if (cloned) {
+      return true;
+    }
+  }
+#endif
+
+  std::ifstream source(filename, std::ios::binary);
+  std::ofstream target(copy_name, std::ios::binary | std::ios::trunc);
+  target << source.rdbuf();
+  return source.good() && target.good();
+}
+
+
+result_cache::result_cache(std::string const& directory)
+  : directory(directory)
+{
+#if defined(_WIN32)
+  _mkdir(directory.c_str());
+#else
+  mkdir(directory.c_str(), 0755);
+#endif
+}
+
+std::string result_cache::entry_name(uint64_t key) const
+{
+  std::ostringstream name;
+  name << directory << "/" << std::hex;
+  name.width(16);
+  name.fill('0');
+  name << key << ".h5";
+  return name.str();
+}
+
+bool result_cache::fetch(uint64_t key, std::string const& filename) const
+{
+  std::string const entry = entry_name(key);
+  if (!fileExists(entry)) {
+    return false;
+  }
+
+  remove(filename.c_str());
+  if (!copy_file(entry, filename)) {
+    std::cerr << ERROR_INFO << "Copying '" << entry << "' to '" << filename << "' not possible." << std::endl;
+    remove(filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool result_cache::store(uint64_t key, std::string const& filename) const
+{
+  // the entry is created under a temporary name and renamed, so that other
+  // runs never see an incomplete entry
+#if defined(_WIN32)
+  int pid = _getpid();
+#else
+  int pid = getpid();
+#endif
+  std::string const entry = entry_name(key);
+  std::string const tmp_entry = entry + "." + std::to_string(pid) + ".tmp";
+
+  remove(tmp_entry.c_str());
+  if (!copy_file(filename, tmp_entry)) {
+    std::cerr << ERROR_INFO << "Storing '" << filename << "' in the result cache '" << directory << "' not possible." << std::endl;
+    remove(tmp_entry.c_str());
+    return false;
+  }
+#if defined(_WIN32)
+  remove(entry.c_str());
+#endif
+  if (rename(tmp_entry.c_str(), entry.c_str()) != 0) {
+    std::cerr << ERROR_INFO << "Storing '" << filename << "' in the result cache '" << directory << "' not possible." << std::endl;
+    remove(tmp_entry.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+// the directories given by `-I dir` or `-Idir` in the build options
+static std::vector<std::string> include_directories(std::string const& build_options)
+{
+  std::vector<std::string> directories;
+  std::istringstream options(build_options.c_str());
+  std::string option;
+  while (options >> option) {
+    if (option.compare(0, 2, "-I") != 0) {
+      continue;
+    }
+    std::string directory = option.substr(2);
+    if (directory.empty() && !(options >> directory)) {
+      break;
+    }
+    if (directory.size() >= 2 && directory.front() == '"' && directory.back() == '"') {
+      directory = directory.substr(1, directory.size() - 2);
+    }
+    directories.push_back(directory);
+  }
+  return directories;
+}
+
+// hash the contents of a file and of the files it includes, in the order of the
+// include directives; `directory` is searched first for includes in quotes
+static uint64_t hash_file(std::string const& path, std::string const& directory,
+  std::vector<std::string> const& include_dirs, std::set<std::string>& visited, uint64_t hash)
+{
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  hash = hash_combine(hash, contents.str());
+
+  contents.seekg(0);
+  std::string line;
+  while (std::getline(contents, line)) {
+    // `# include "name"` or `#include <name>`; conditional directives are ignored,
+    // so headers excluded by the preprocessor are hashed as well
+    size_t pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos || line[pos] != '#') {
+      continue;
+    }
+    pos = line.find_first_not_of(" \t", pos + 1);
+    if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) {
+      continue;
+    }
+    pos = line.find_first_not_of(" \t", pos + 7);
+    if (pos == std::string::npos || (line[pos] != '"' && line[pos] != '<')) {
+      continue;
+    }
+    size_t end = line.find(line[pos] == '"' ? '"' : '>', pos + 1);
+    if (end == std::string::npos) {
+      continue;
+    }
+    std::string name = line.substr(pos + 1, end - pos - 1);
+
+    std::vector<std::string> candidates;
+    if (line[pos] == '"') {
+      candidates.push_back(directory + name);
+    }
+    for (std::string const& include_dir : include_dirs) {
+      candidates.push_back(include_dir + "/" + name);
+    }
+    // includes not found, e.g. of headers provided by the compiler, are skipped
+    for (std::string const& candidate : candidates) {
+      if (fileExists(candidate)) {
+        if (visited.insert(candidate).second) {
+          std::string candidate_dir = candidate.substr(0, candidate.find_last_of("/\\") + 1);
+          hash = hash_file(candidate, candidate_dir, include_dirs, visited, hash);
+        }
+        break;
+      }
+    }
+  }
+  return hash;
+}
+
+uint64_t hash_kernel_source(std::string const& filename, std::string const& build_options, uint64_t hash)
+{
+  // the source is passed to the compiler as text, so includes in quotes are
+  // relative to the working directory rather than to the source file
+  std::set<std::string> visited;
+  return hash_file(filename, "", include_directories(build_options), visited, hash);
+}
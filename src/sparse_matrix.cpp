@@ -0,0 +1,487 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+#include "sparse_matrix.hpp"
+
+
+using namespace std;
+
+
+bool check_sparse_matrix(char const* filename, char const* groupname)
+{
+  string group(groupname);
+  return h5_check_object(filename, (group + "/col_idx").c_str())
+      && h5_check_object(filename, (group + "/values").c_str())
+      && (h5_check_object(filename, (group + "/row_ptr").c_str()) || h5_check_object(filename, (group + "/row_idx").c_str()));
+}
+
+
+// read an integer attribute of a group, if present, as a dimension of a matrix;
+// false if the attribute is present but not a valid dimension
+static bool read_dimension(char const* filename, char const* groupname, char const* attr_name, cl_uint& value, bool& present)
+{
+  present = h5_check_attribute(filename, groupname, attr_name);
+  if (!present) {
+    return true;
+  }
+
+  cl_ulong tmp = 0;
+  h5_read_attribute<cl_ulong>(filename, groupname, attr_name, tmp);
+  if (tmp > numeric_limits<cl_int>::max()) {
+    cerr << ERROR_INFO << "Attribute '" << attr_name << "' of '" << groupname << "' exceeds the range of int." << endl;
+    return false;
+  }
+  value = (cl_uint)tmp;
+  return true;
+}
+
+
+// sort the entries of every row by their column index
+static void sort_rows(sparse_matrix& matrix)
+{
+  if (matrix.col_idx.empty()) {
+    return;
+  }
+
+  size_t const value_size = get_type_size(matrix.value_type);
+  vector<size_t> order;
+  vector<cl_int> cols;
+  vector<uint8_t> vals;
+
+  for (cl_uint row = 0; row < matrix.num_rows; row++) {
+    size_t const begin = matrix.row_ptr.at(row);
+    size_t const count = matrix.row_ptr.at(row + 1) - begin;
+    cl_int* row_cols = &matrix.col_idx[0] + begin;
+    if (is_sorted(row_cols, row_cols + count)) {
+      continue;
+    }
+
+    order.resize(count);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [row_cols](size_t a, size_t b) { return row_cols[a] < row_cols[b]; });
+
+    uint8_t* row_vals = &matrix.values[0] + begin * value_size;
+    cols.assign(row_cols, row_cols + count);
+    vals.assign(row_vals, row_vals + count * value_size);
+    for (size_t idx = 0; idx < count; idx++) {
+      row_cols[idx] = cols.at(order.at(idx));
+      memcpy(row_vals + idx * value_size, &vals[0] + order.at(idx) * value_size, value_size);
+    }
+  }
+}
+
+
+bool read_sparse_matrix(char const* filename, char const* groupname, sparse_matrix& matrix)
+{
+  string group(groupname);
+
+  // the datasets of the group and their types
+  vector<string> names;
+  vector<HD5_Type> types;
+  vector<size_t> sizes;
+  h5_get_content(filename, (group + "/").c_str(), names, types, sizes);
+
+  size_t nnz = 0, num_col_entries = 0, num_row_entries = 0;
+  bool found_values = false, csr = false;
+  for (size_t idx = 0; idx < names.size(); idx++) {
+    if (names.at(idx) == group + "/values") {
+      matrix.value_type = types.at(idx);
+      nnz = sizes.at(idx);
+      found_values = true;
+    }
+    else if (names.at(idx) == group + "/col_idx") {
+      num_col_entries = sizes.at(idx);
+    }
+    else if (names.at(idx) == group + "/row_ptr") {
+      num_row_entries = sizes.at(idx);
+      csr = true;
+    }
+    else if (names.at(idx) == group + "/row_idx" && !csr) {
+      num_row_entries = sizes.at(idx);
+    }
+  }
+  if (!found_values || matrix.value_type == H5_compound) {
+    cerr << ERROR_INFO << "Values of the sparse matrix '" << groupname << "' must be scalars." << endl;
+    return false;
+  }
+  if (nnz > (size_t)numeric_limits<cl_int>::max()) {
+    cerr << ERROR_INFO << "Number of entries of the sparse matrix '" << groupname << "' exceeds the range of int." << endl;
+    return false;
+  }
+  if (num_col_entries != nnz) {
+    cerr << ERROR_INFO << "Datasets 'col_idx' and 'values' of '" << groupname << "' differ in size." << endl;
+    return false;
+  }
+
+  size_t const value_size = get_type_size(matrix.value_type);
+  matrix.col_idx.resize(nnz);
+  matrix.values.resize(nnz * value_size);
+  if (nnz > 0) {
+    h5_read_buffer<cl_int>(filename, (group + "/col_idx").c_str(), &matrix.col_idx[0]);
+    h5_read_device_buffer(filename, (group + "/values").c_str(), H5_Device_Layout{nnz, 1, value_size, {}}, &matrix.values[0]);
+  }
+
+  cl_int max_col = -1;
+  for (cl_int col : matrix.col_idx) {
+    if (col < 0) {
+      cerr << ERROR_INFO << "Negative column index in the sparse matrix '" << groupname << "'." << endl;
+      return false;
+    }
+    max_col = max(max_col, col);
+  }
+  bool present = false;
+  if (!read_dimension(filename, groupname, "num_cols", matrix.num_cols, present)) {
+    return false;
+  }
+  if (!present) {
+    matrix.num_cols = max_col + 1;
+  }
+  if (max_col >= (cl_int)matrix.num_cols) {
+    cerr << ERROR_INFO << "Column index out of range in the sparse matrix '" << groupname << "'." << endl;
+    return false;
+  }
+
+  if (csr) {
+    if (num_row_entries == 0) {
+      cerr << ERROR_INFO << "Dataset 'row_ptr' of the sparse matrix '" << groupname << "' is empty." << endl;
+      return false;
+    }
+    matrix.row_ptr.resize(num_row_entries);
+    h5_read_buffer<cl_int>(filename, (group + "/row_ptr").c_str(), &matrix.row_ptr[0]);
+    matrix.num_rows = num_row_entries - 1;
+
+    cl_uint num_rows = 0;
+    if (!read_dimension(filename, groupname, "num_rows", num_rows, present)) {
+      return false;
+    }
+    if (present && num_rows != matrix.num_rows) {
+      cerr << ERROR_INFO << "Attribute 'num_rows' of '" << groupname << "' does not match 'row_ptr'." << endl;
+      return false;
+    }
+    if (matrix.row_ptr.front() != 0 || matrix.row_ptr.back() != (cl_int)nnz
+        || !is_sorted(matrix.row_ptr.begin(), matrix.row_ptr.end())) {
+      cerr << ERROR_INFO << "Dataset 'row_ptr' of the sparse matrix '" << groupname << "' is invalid." << endl;
+      return false;
+    }
+  }
+  else {
+    // COO entries are grouped by rows (counting sort); the columns are sorted below
+    if (num_row_entries != nnz) {
+      cerr << ERROR_INFO << "Datasets 'row_idx' and 'values' of '" << groupname << "' differ in size." << endl;
+      return false;
+    }
+    vector<cl_int> row_idx(nnz);
+    if (nnz > 0) {
+      h5_read_buffer<cl_int>(filename, (group + "/row_idx").c_str(), &row_idx[0]);
+    }
+
+    cl_int max_row = -1;
+    for (cl_int row : row_idx) {
+      if (row < 0) {
+        cerr << ERROR_INFO << "Negative row index in the sparse matrix '" << groupname << "'." << endl;
+        return false;
+      }
+      max_row = max(max_row, row);
+    }
+    if (!read_dimension(filename, groupname, "num_rows", matrix.num_rows, present)) {
+      return false;
+    }
+    if (!present) {
+      matrix.num_rows = max_row + 1;
+    }
+    if (max_row >= (cl_int)matrix.num_rows) {
+      cerr << ERROR_INFO << "Row index out of range in the sparse matrix '" << groupname << "'." << endl;
+      return false;
+    }
+
+    matrix.row_ptr.assign(matrix.num_rows + 1, 0);
+    for (cl_int row : row_idx) {
+      matrix.row_ptr.at(row + 1)++;
+    }
+    partial_sum(matrix.row_ptr.begin(), matrix.row_ptr.end(), matrix.row_ptr.begin());
+
+    vector<cl_int> next(matrix.row_ptr.begin(), matrix.row_ptr.end() - 1);
+    vector<cl_int> col_idx(nnz);
+    vector<uint8_t> values(nnz * value_size);
+    for (size_t idx = 0; idx < nnz; idx++) {
+      cl_int pos = next.at(row_idx.at(idx))++;
+      col_idx.at(pos) = matrix.col_idx.at(idx);
+      memcpy(&values[0] + pos * value_size, &matrix.values[0] + idx * value_size, value_size);
+    }
+    matrix.col_idx.swap(col_idx);
+    matrix.values.swap(values);
+  }
+
+  sort_rows(matrix);
+
+  matrix.format = "csr";
+  if (h5_check_attribute(filename, groupname, "sparse_format")) {
+    h5_read_attribute_string(filename, groupname, "sparse_format", matrix.format);
+    if (matrix.format != "csr" && matrix.format != "ell") {
+      cerr << ERROR_INFO << "Unknown sparse format '" << matrix.format << "' of '" << groupname << "'." << endl;
+      return false;
+    }
+  }
+
+  matrix.permutation.clear();
+  if (h5_check_attribute(filename, groupname, "sparse_reorder")) {
+    string reorder;
+    h5_read_attribute_string(filename, groupname, "sparse_reorder", reorder);
+    if (reorder == "rcm") {
+      return reorder_rcm(matrix);
+    }
+    else if (reorder != "none") {
+      cerr << ERROR_INFO << "Unknown reordering '" << reorder << "' of '" << groupname << "'." << endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+// Breadth first search from `start` within the nodes not yet numbered; returns
+// the nodes in the order they are visited and their levels. The level of every
+// visited node is reset to -1 before returning.
+static void bfs(vector<cl_int> const& adj_ptr, vector<cl_int> const& adj, vector<cl_int> const& degree,
+  vector<bool> const& numbered, cl_int start, vector<cl_int>& level, vector<cl_int>& visited, vector<cl_int>& visited_levels)
+{
+  visited.assign(1, start);
+  visited_levels.assign(1, 0);
+  level.at(start) = 0;
+  vector<cl_int> neighbours;
+
+  for (size_t head = 0; head < visited.size(); head++) {
+    cl_int node = visited.at(head);
+
+    // neighbours are visited in the order of increasing degree
+    neighbours.clear();
+    for (cl_int idx = adj_ptr.at(node); idx < adj_ptr.at(node + 1); idx++) {
+      cl_int next = adj.at(idx);
+      if (!numbered.at(next) && level.at(next) < 0) {
+        level.at(next) = level.at(node) + 1;
+        neighbours.push_back(next);
+      }
+    }
+    stable_sort(neighbours.begin(), neighbours.end(), [&degree](cl_int a, cl_int b) { return degree.at(a) < degree.at(b); });
+    for (cl_int next : neighbours) {
+      visited.push_back(next);
+      visited_levels.push_back(level.at(next));
+    }
+  }
+
+  for (cl_int node : visited) {
+    level.at(node) = -1;
+  }
+}
+
+
+bool reorder_rcm(sparse_matrix& matrix)
+{
+  if (matrix.num_rows != matrix.num_cols) {
+    cerr << ERROR_INFO << "Only square sparse matrices can be reordered." << endl;
+    return false;
+  }
+  cl_int const n = matrix.num_rows;
+
+  // adjacency lists of the pattern of A + A^T without the diagonal
+  vector<cl_int> adj_ptr(n + 1, 0);
+  for (cl_int row = 0; row < n; row++) {
+    for (cl_int idx = matrix.row_ptr.at(row); idx < matrix.row_ptr.at(row + 1); idx++) {
+      cl_int col = matrix.col_idx.at(idx);
+      if (col != row) {
+        adj_ptr.at(row + 1)++;
+        adj_ptr.at(col + 1)++;
+      }
+    }
+  }
+  partial_sum(adj_ptr.begin(), adj_ptr.end(), adj_ptr.begin());
+
+  vector<cl_int> adj(adj_ptr.back());
+  vector<cl_int> next(adj_ptr.begin(), adj_ptr.end() - 1);
+  for (cl_int row = 0; row < n; row++) {
+    for (cl_int idx = matrix.row_ptr.at(row); idx < matrix.row_ptr.at(row + 1); idx++) {
+      cl_int col = matrix.col_idx.at(idx);
+      if (col != row) {
+        adj.at(next.at(row)++) = col;
+        adj.at(next.at(col)++) = row;
+      }
+    }
+  }
+
+  // remove duplicates of symmetric entries
+  vector<cl_int> degree(n);
+  {
+    cl_int pos = 0;
+    for (cl_int node = 0; node < n; node++) {
+      auto first = adj.begin() + adj_ptr.at(node);
+      auto last = adj.begin() + adj_ptr.at(node + 1);
+      sort(first, last);
+      last = unique(first, last);
+      adj_ptr.at(node) = pos;
+      pos = copy(first, last, adj.begin() + pos) - adj.begin();
+      degree.at(node) = pos - adj_ptr.at(node);
+    }
+    adj_ptr.at(n) = pos;
+    adj.resize(pos);
+  }
+
+  // Cuthill-McKee ordering of every connected component, starting at a
+  // pseudo-peripheral node found by repeated searches (George and Liu)
+  vector<cl_int> order;
+  order.reserve(n);
+  vector<bool> numbered(n, false);
+  vector<cl_int> level(n, -1), visited, visited_levels;
+
+  cl_int min_node = 0;
+  while ((cl_int)order.size() < n) {
+    while (numbered.at(min_node)) {
+      min_node++;
+    }
+    cl_int start = min_node;
+    for (cl_int node = min_node; node < n; node++) {
+      if (!numbered.at(node) && degree.at(node) < degree.at(start)) {
+        start = node;
+      }
+    }
+
+    bfs(adj_ptr, adj, degree, numbered, start, level, visited, visited_levels);
+    while (true) {
+      cl_int eccentricity = visited_levels.back();
+      cl_int candidate = visited.back();
+      for (size_t idx = visited.size(); idx > 0 && visited_levels.at(idx - 1) == eccentricity; idx--) {
+        if (degree.at(visited.at(idx - 1)) < degree.at(candidate)) {
+          candidate = visited.at(idx - 1);
+        }
+      }
+      if (candidate == start) {
+        break;
+      }
+      vector<cl_int> candidate_visited, candidate_levels;
+      bfs(adj_ptr, adj, degree, numbered, candidate, level, candidate_visited, candidate_levels);
+      if (candidate_levels.back() <= eccentricity) {
+        break;
+      }
+      start = candidate;
+      visited.swap(candidate_visited);
+      visited_levels.swap(candidate_levels);
+    }
+
+    for (cl_int node : visited) {
+      numbered.at(node) = true;
+      order.push_back(node);
+    }
+  }
+  reverse(order.begin(), order.end());
+
+  // B = P A P^T, i.e. row i of B is row order[i] of A with renumbered columns
+  vector<cl_int> inverse(n);
+  for (cl_int node = 0; node < n; node++) {
+    inverse.at(order.at(node)) = node;
+  }
+
+  size_t const value_size = get_type_size(matrix.value_type);
+  vector<cl_int> row_ptr(n + 1, 0);
+  vector<cl_int> col_idx(matrix.col_idx.size());
+  vector<uint8_t> values(matrix.values.size());
+  for (cl_int row = 0; row < n; row++) {
+    cl_int old_row = order.at(row);
+    cl_int begin = matrix.row_ptr.at(old_row);
+    cl_int count = matrix.row_ptr.at(old_row + 1) - begin;
+    row_ptr.at(row + 1) = row_ptr.at(row) + count;
+    for (cl_int idx = 0; idx < count; idx++) {
+      col_idx.at(row_ptr.at(row) + idx) = inverse.at(matrix.col_idx.at(begin + idx));
+    }
+    if (count > 0) {
+      memcpy(&values[0] + row_ptr.at(row) * value_size, &matrix.values[0] + begin * value_size, count * value_size);
+    }
+  }
+  matrix.row_ptr.swap(row_ptr);
+  matrix.col_idx.swap(col_idx);
+  matrix.values.swap(values);
+  matrix.permutation.swap(order);
+  sort_rows(matrix);
+
+  return true;
+}
+
+
+// append a buffer or scalar argument
+static void add_argument(sparse_arguments& arguments, char const* name, HD5_Type type, size_t size, bool scalar, void const* data)
+{
+  size_t bytes = size * get_type_size(type);
+  arguments.names.push_back(name);
+  arguments.types.push_back(type);
+  arguments.sizes.push_back(size);
+  arguments.scalars.push_back(scalar);
+  arguments.data.push_back(vector<uint8_t>((uint8_t const*)data, (uint8_t const*)data + bytes));
+}
+
+
+bool get_sparse_arguments(sparse_matrix const& matrix, sparse_arguments& arguments)
+{
+  arguments = sparse_arguments();
+  size_t const nnz = matrix.col_idx.size();
+  size_t const value_size = get_type_size(matrix.value_type);
+
+  if (matrix.format == "ell") {
+    // short rows are padded with zeros at their last column to stay in the cache lines used by the row
+    cl_uint width = 0;
+    for (cl_uint row = 0; row < matrix.num_rows; row++) {
+      width = max(width, (cl_uint)(matrix.row_ptr.at(row + 1) - matrix.row_ptr.at(row)));
+    }
+    size_t const size = (size_t)width * matrix.num_rows;
+    if (size > (size_t)numeric_limits<cl_int>::max()) {
+      cerr << ERROR_INFO << "Size of the ELL matrix exceeds the range of int." << endl;
+      return false;
+    }
+
+    vector<cl_int> col_idx(size, 0);
+    vector<uint8_t> values(size * value_size, 0);
+    for (cl_uint row = 0; row < matrix.num_rows; row++) {
+      cl_int begin = matrix.row_ptr.at(row);
+      cl_int count = matrix.row_ptr.at(row + 1) - begin;
+      for (cl_int k = 0; k < (cl_int)width; k++) {
+        size_t pos = (size_t)k * matrix.num_rows + row;
+        if (k < count) {
+          col_idx.at(pos) = matrix.col_idx.at(begin + k);
+          memcpy(&values[0] + pos * value_size, &matrix.values[0] + (begin + k) * value_size, value_size);
+        }
+        else if (count > 0) {
+          col_idx.at(pos) = matrix.col_idx.at(begin + count - 1);
+        }
+      }
+    }
+
+    add_argument(arguments, "col_idx", H5_int, size, false, col_idx.data());
+    add_argument(arguments, "values", matrix.value_type, size, false, values.data());
+    if (!matrix.permutation.empty()) {
+      add_argument(arguments, "permutation", H5_int, matrix.permutation.size(), false, matrix.permutation.data());
+    }
+    add_argument(arguments, "num_rows", H5_uint, 1, true, &matrix.num_rows);
+    add_argument(arguments, "num_cols", H5_uint, 1, true, &matrix.num_cols);
+    add_argument(arguments, "width", H5_uint, 1, true, &width);
+  }
+  else {
+    add_argument(arguments, "row_ptr", H5_int, matrix.row_ptr.size(), false, matrix.row_ptr.data());
+    add_argument(arguments, "col_idx", H5_int, nnz, false, matrix.col_idx.data());
+    add_argument(arguments, "values", matrix.value_type, nnz, false, matrix.values.data());
+    if (!matrix.permutation.empty()) {
+      add_argument(arguments, "permutation", H5_int, matrix.permutation.size(), false, matrix.permutation.data());
+    }
+    add_argument(arguments, "num_rows", H5_uint, 1, true, &matrix.num_rows);
+    add_argument(arguments, "num_cols", H5_uint, 1, true, &matrix.num_cols);
+  }
+
+  return true;
+}
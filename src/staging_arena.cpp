@@ -0,0 +1,187 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <algorithm>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "util.hpp"
+#include "staging_arena.hpp"
+
+
+#if defined(__linux__)
+static const size_t huge_page_size = 2 * 1024 * 1024;
+#endif
+
+
+// allocate page aligned host memory, backed by huge pages if possible
+static uint8_t* alloc_pages(size_t size, size_t page_size, bool huge_pages)
+{
+#if defined(_WIN32)
+  return (uint8_t*)_aligned_malloc(size, page_size);
+#else
+#if defined(__linux__) && defined(MAP_HUGETLB)
+  if (huge_pages) {
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+      return (uint8_t*)ptr;
+    }
+  }
+#endif
+  // no reserved huge pages; fall back to (transparent huge) pages
+  void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (huge_pages) {
+    madvise(ptr, size, MADV_HUGEPAGE);
+  }
+#endif
+  return (uint8_t*)ptr;
+#endif
+}
+
+static void free_pages(uint8_t* ptr, size_t size)
+{
+#if defined(_WIN32)
+  _aligned_free(ptr);
+#else
+  munmap(ptr, size);
+#endif
+}
+
+
+staging_arena::staging_arena(cl::Context& context, cl::CommandQueue& queue, bool huge_pages)
+  : context(context), queue(queue), huge_pages(huge_pages), used_size(0), max_size(0)
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  page_size = info.dwPageSize;
+#else
+  page_size = sysconf(_SC_PAGESIZE);
+#endif
+
+#if defined(__linux__)
+  if (huge_pages) {
+    page_size = huge_page_size;
+  }
+#endif
+}
+
+staging_arena::~staging_arena()
+{
+  for (block& blk : blocks) {
+    free_block(blk);
+  }
+}
+
+
+size_t staging_arena::round_up(size_t size) const
+{
+  return ((size + page_size - 1) / page_size) * page_size;
+}
+
+void staging_arena::free_block(block& blk)
+{
+  try {
+    if (blk.host_alloc) {
+      blk.buffer = cl::Buffer();
+      free_pages(blk.ptr, blk.size);
+    }
+    else {
+      queue.enqueueUnmapMemObject(blk.buffer, blk.ptr);
+      queue.finish();
+    }
+  }
+  catch (cl::Error err) {
+    std::cerr << ERROR_INFO << "Exception: " << err.what() << std::endl;
+  }
+}
+
+
+uint8_t* staging_arena::acquire(size_t size)
+{
+  size = round_up(std::max(size, (size_t)1));
+
+  // reuse the smallest free block which is large enough
+  block* best = nullptr;
+  for (block& blk : blocks) {
+    if (!blk.in_use && blk.size >= size && (best == nullptr || blk.size < best->size)) {
+      best = &blk;
+    }
+  }
+  if (best != nullptr) {
+    best->in_use = true;
+    used_size += best->size;
+    max_size = std::max(max_size, used_size);
+    return best->ptr;
+  }
+
+  // the free blocks are too small, so they are returned before a larger block is
+  // allocated; thus, the arena holds about the memory in use at the same time
+  for (block& blk : blocks) {
+    if (!blk.in_use) {
+      free_block(blk);
+    }
+  }
+  blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [](block const& blk) { return !blk.in_use; }), blocks.end());
+
+  block blk;
+  blk.size = size;
+  blk.in_use = true;
+  blk.host_alloc = huge_pages;
+
+  if (blk.host_alloc) {
+    blk.ptr = alloc_pages(size, page_size, huge_pages);
+    if (blk.ptr == nullptr) {
+      std::cerr << ERROR_INFO << "Allocating " << size << " bytes of staging memory not possible." << std::endl;
+      return nullptr;
+    }
+  }
+
+  try {
+    if (blk.host_alloc) {
+      // the pages are pinned by the OpenCL runtime while the buffer exists
+      blk.buffer = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, size, blk.ptr);
+    }
+    else {
+      blk.buffer = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, size);
+      blk.ptr = (uint8_t*)queue.enqueueMapBuffer(blk.buffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, size);
+    }
+  }
+  catch (cl::Error err) {
+    std::cerr << ERROR_INFO << "Allocating " << size << " bytes of staging memory not possible. Exception: " << err.what() << std::endl;
+    if (blk.host_alloc) {
+      blk.buffer = cl::Buffer();
+      free_pages(blk.ptr, size);
+    }
+    return nullptr;
+  }
+
+  blocks.push_back(blk);
+  used_size += size;
+  max_size = std::max(max_size, used_size);
+
+  return blk.ptr;
+}
+
+void staging_arena::release(uint8_t* ptr)
+{
+  for (block& blk : blocks) {
+    if (blk.ptr == ptr && blk.in_use) {
+      blk.in_use = false;
+      used_size -= blk.size;
+      return;
+    }
+  }
+
+  std::cerr << ERROR_INFO << "Staging memory " << (void*)ptr << " was not acquired from the arena." << std::endl;
+}
@@ -0,0 +1,117 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <algorithm>
+#include <iostream>
+
+#include "util.hpp"
+#include "svm_memory.hpp"
+
+
+// The C API of OpenCL 2.0 is used, since the C++ bindings target OpenCL 1.2.
+// Without headers of OpenCL 2.0, SVM is never supported.
+
+#if defined(CL_VERSION_2_0)
+static cl_device_svm_capabilities get_svm_capabilities(cl::Device const& device)
+{
+  // devices of OpenCL 1.x reject the query
+  cl_device_svm_capabilities capabilities = 0;
+  if (clGetDeviceInfo(device(), CL_DEVICE_SVM_CAPABILITIES, sizeof(capabilities), &capabilities, NULL) != CL_SUCCESS) {
+    return 0;
+  }
+  return capabilities;
+}
+#endif
+
+
+bool svm_memory::is_supported(cl::Device const& device)
+{
+#if defined(CL_VERSION_2_0)
+  return (get_svm_capabilities(device) & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER) != 0;
+#else
+  return false;
+#endif
+}
+
+
+svm_memory::svm_memory(cl::Context& context, cl::CommandQueue& queue, cl::Device const& device)
+  : context(context), queue(queue), fine_grain(false)
+{
+#if defined(CL_VERSION_2_0)
+  fine_grain = (get_svm_capabilities(device) & CL_DEVICE_SVM_FINE_GRAIN_BUFFER) != 0;
+#endif
+}
+
+svm_memory::~svm_memory()
+{
+#if defined(CL_VERSION_2_0)
+  try {
+    queue.finish();
+  }
+  catch (cl::Error err) {
+    std::cerr << ERROR_INFO << "Exception: " << err.what() << std::endl;
+  }
+  for (void* ptr : allocations) {
+    clSVMFree(context(), ptr);
+  }
+#endif
+}
+
+
+void* svm_memory::allocate(size_t size, cl_mem_flags flags, cl::Buffer& buffer)
+{
+#if defined(CL_VERSION_2_0)
+  cl_svm_mem_flags svm_flags = flags & (CL_MEM_READ_WRITE | CL_MEM_WRITE_ONLY | CL_MEM_READ_ONLY);
+  if (fine_grain) {
+    svm_flags |= CL_MEM_SVM_FINE_GRAIN_BUFFER;
+  }
+
+  void* ptr = clSVMAlloc(context(), svm_flags, std::max(size, (size_t)1), 0);
+  if (ptr == nullptr) {
+    throw cl::Error(CL_MEM_OBJECT_ALLOCATION_FAILURE, "clSVMAlloc");
+  }
+  allocations.push_back(ptr);
+
+  buffer = cl::Buffer(context, flags | CL_MEM_USE_HOST_PTR, std::max(size, (size_t)1), ptr);
+  return ptr;
+#else
+  throw cl::Error(CL_INVALID_OPERATION, "clSVMAlloc");
+#endif
+}
+
+
+void svm_memory::map(void* ptr, size_t size, cl_map_flags flags)
+{
+#if defined(CL_VERSION_2_0)
+  if (fine_grain) {
+    return;
+  }
+  cl_int err = clEnqueueSVMMap(queue(), CL_TRUE, flags, ptr, size, 0, NULL, NULL);
+  if (err != CL_SUCCESS) {
+    throw cl::Error(err, "clEnqueueSVMMap");
+  }
+#endif
+}
+
+void svm_memory::unmap(void* ptr)
+{
+#if defined(CL_VERSION_2_0)
+  if (fine_grain) {
+    return;
+  }
+  cl_int err = clEnqueueSVMUnmap(queue(), ptr, 0, NULL, NULL);
+  if (err != CL_SUCCESS) {
+    throw cl::Error(err, "clEnqueueSVMUnmap");
+  }
+#endif
+}
+
+
+void svm_memory::set_arg(cl::Kernel& kernel, cl_uint arg_idx, void* ptr)
+{
+#if defined(CL_VERSION_2_0)
+  cl_int err = clSetKernelArgSVMPointer(kernel(), arg_idx, ptr);
+  if (err != CL_SUCCESS) {
+    throw cl::Error(err, "clSetKernelArgSVMPointer");
+  }
+#endif
+}
@@ -0,0 +1,361 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #include <emmintrin.h>
+  #define USE_SSE2
+#endif
+
+#if defined(__F16C__)
+  #include <immintrin.h>
+  #define USE_F16C
+#endif
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+#include "type_conversion.hpp"
+
+
+using namespace std;
+
+
+// Conversion of a single value. Conversions to floating point types are plain
+// casts; conversions to integer types saturate, and floating point values are
+// truncated towards zero (NaNs are converted to zero).
+template<typename SRC, typename DST,
+         bool DST_FLOAT = std::is_floating_point<DST>::value, bool SRC_FLOAT = std::is_floating_point<SRC>::value>
+struct value_converter;
+
+template<typename SRC, typename DST, bool SRC_FLOAT>
+struct value_converter<SRC, DST, true, SRC_FLOAT> {
+  static inline DST convert(SRC value) { return static_cast<DST>(value); }
+};
+
+template<typename SRC, typename DST>
+struct value_converter<SRC, DST, false, true> {
+  static inline DST convert(SRC value)
+  {
+    if (!(value == value)) {
+      return 0;
+    }
+    if (value <= static_cast<SRC>(std::numeric_limits<DST>::min())) {
+      return std::numeric_limits<DST>::min();
+    }
+    if (value >= static_cast<SRC>(std::numeric_limits<DST>::max())) {
+      return std::numeric_limits<DST>::max();
+    }
+    return static_cast<DST>(value);
+  }
+};
+
+template<typename SRC, typename DST>
+struct value_converter<SRC, DST, false, false> {
+  static inline DST convert(SRC value)
+  {
+    if (std::numeric_limits<SRC>::is_signed && value < static_cast<SRC>(0)) {
+      if (!std::numeric_limits<DST>::is_signed) {
+        return 0;
+      }
+      return static_cast<intmax_t>(value) < static_cast<intmax_t>(std::numeric_limits<DST>::min())
+             ? std::numeric_limits<DST>::min() : static_cast<DST>(value);
+    }
+    return static_cast<uintmax_t>(value) > static_cast<uintmax_t>(std::numeric_limits<DST>::max())
+           ? std::numeric_limits<DST>::max() : static_cast<DST>(value);
+  }
+};
+
+
+// Conversion of a buffer. The generic version is written to be vectorized by
+// the compiler; the most frequent conversions are vectorized explicitly.
+template<typename SRC, typename DST>
+static void convert_elements(SRC const* src, DST* dst, size_t num_elements)
+{
+  for (size_t idx = 0; idx < num_elements; ++idx) {
+    dst[idx] = value_converter<SRC, DST>::convert(src[idx]);
+  }
+}
+
+#ifdef USE_SSE2
+template<>
+void convert_elements<cl_double, cl_float>(cl_double const* src, cl_float* dst, size_t num_elements)
+{
+  size_t idx = 0;
+  for (; idx + 4 <= num_elements; idx += 4) {
+    __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(src + idx));
+    __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(src + idx + 2));
+    _mm_storeu_ps(dst + idx, _mm_movelh_ps(low, high));
+  }
+  for (; idx < num_elements; ++idx) {
+    dst[idx] = static_cast<cl_float>(src[idx]);
+  }
+}
+
+template<>
+void convert_elements<cl_float, cl_double>(cl_float const* src, cl_double* dst, size_t num_elements)
+{
+  size_t idx = 0;
+  for (; idx + 4 <= num_elements; idx += 4) {
+    __m128 values = _mm_loadu_ps(src + idx);
+    _mm_storeu_pd(dst + idx, _mm_cvtps_pd(values));
+    _mm_storeu_pd(dst + idx + 2, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+  }
+  for (; idx < num_elements; ++idx) {
+    dst[idx] = static_cast<cl_double>(src[idx]);
+  }
+}
+
+// narrowing with signed saturation
+template<>
+void convert_elements<cl_int, cl_short>(cl_int const* src, cl_short* dst, size_t num_elements)
+{
+  size_t idx = 0;
+  for (; idx + 8 <= num_elements; idx += 8) {
+    __m128i low = _mm_loadu_si128((__m128i const*)(src + idx));
+    __m128i high = _mm_loadu_si128((__m128i const*)(src + idx + 4));
+    _mm_storeu_si128((__m128i*)(dst + idx), _mm_packs_epi32(low, high));
+  }
+  for (; idx < num_elements; ++idx) {
+    dst[idx] = value_converter<cl_int, cl_short>::convert(src[idx]);
+  }
+}
+
+// widening with sign extension
+template<>
+void convert_elements<cl_short, cl_int>(cl_short const* src, cl_int* dst, size_t num_elements)
+{
+  size_t idx = 0;
+  for (; idx + 8 <= num_elements; idx += 8) {
+    __m128i values = _mm_loadu_si128((__m128i const*)(src + idx));
+    _mm_storeu_si128((__m128i*)(dst + idx), _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16));
+    _mm_storeu_si128((__m128i*)(dst + idx + 4), _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16));
+  }
+  for (; idx < num_elements; ++idx) {
+    dst[idx] = static_cast<cl_int>(src[idx]);
+  }
+}
+#endif // USE_SSE2
+
+
+// Conversion between single and half precision, rounding to nearest even.
+// Values too large for half precision are converted to infinity.
+static inline cl_half float_to_half(cl_float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+
+  uint32_t sign = (bits >> 16) & 0x8000;
+  uint32_t abs = bits & 0x7fffffff;
+
+  if (abs >= 0x7f800000) { // infinity or NaN
+    return (cl_half)(sign | (abs > 0x7f800000 ? 0x7e00 : 0x7c00));
+  }
+  if (abs >= 0x477ff000) { // at least 65520, rounded to infinity
+    return (cl_half)(sign | 0x7c00);
+  }
+  if (abs < 0x38800000) { // subnormal half precision values
+    if (abs < 0x33000000) {
+      return (cl_half)sign;
+    }
+    uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+    uint32_t shift = 126 - (abs >> 23);
+    uint32_t result = mantissa >> shift;
+    uint32_t remainder = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (result & 1))) {
+      result++;
+    }
+    return (cl_half)(sign | result);
+  }
+
+  // rebias the exponent from 127 to 15
+  uint32_t result = (abs - 0x38000000) >> 13;
+  uint32_t remainder = abs & 0x1fff;
+  if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1))) {
+    result++;
+  }
+  return (cl_half)(sign | result);
+}
+
+static inline cl_float half_to_float(cl_half value)
+{
+  uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+  uint32_t exponent = (value >> 10) & 0x1f;
+  uint32_t mantissa = value & 0x3ff;
+
+  uint32_t bits;
+  if (exponent == 0) { // zero or subnormal
+    cl_float result = mantissa * (1.0f / 16777216.0f);
+    return sign ? -result : result;
+  }
+  else if (exponent == 0x1f) { // infinity or NaN
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  }
+  else {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+
+  cl_float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+static void float_to_half_elements(cl_float const* src, cl_half* dst, size_t num_elements)
+{
+  size_t idx = 0;
+#ifdef USE_F16C
+  for (; idx + 4 <= num_elements; idx += 4) {
+    __m128i values = _mm_cvtps_ph(_mm_loadu_ps(src + idx), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storel_epi64((__m128i*)(dst + idx), values);
+  }
+#endif
+  for (; idx < num_elements; ++idx) {
+    dst[idx] = float_to_half(src[idx]);
+  }
+}
+
+static void half_to_float_elements(cl_half const* src, cl_float* dst, size_t num_elements)
+{
+  size_t idx = 0;
+#ifdef USE_F16C
+  for (; idx + 4 <= num_elements; idx += 4) {
+    _mm_storeu_ps(dst + idx, _mm_cvtph_ps(_mm_loadl_epi64((__m128i const*)(src + idx))));
+  }
+#endif
+  for (; idx < num_elements; ++idx) {
+    dst[idx] = half_to_float(src[idx]);
+  }
+}
+
+
+template<typename SRC>
+static bool convert_from(SRC const* src, void* dst, HD5_Type dst_type, size_t num_elements)
+{
+  switch (dst_type) {
+    case H5_float:  convert_elements(src, (cl_float*)dst,  num_elements); return true;
+    case H5_double: convert_elements(src, (cl_double*)dst, num_elements); return true;
+    case H5_char:   convert_elements(src, (cl_char*)dst,   num_elements); return true;
+    case H5_uchar:  convert_elements(src, (cl_uchar*)dst,  num_elements); return true;
+    case H5_short:  convert_elements(src, (cl_short*)dst,  num_elements); return true;
+    case H5_ushort: convert_elements(src, (cl_ushort*)dst, num_elements); return true;
+    case H5_int:    convert_elements(src, (cl_int*)dst,    num_elements); return true;
+    case H5_uint:   convert_elements(src, (cl_uint*)dst,   num_elements); return true;
+    case H5_long:   convert_elements(src, (cl_long*)dst,   num_elements); return true;
+    case H5_ulong:  convert_elements(src, (cl_ulong*)dst,  num_elements); return true;
+    case H5_half:
+    case H5_compound: break;
+  }
+
+  return false;
+}
+
+
+bool parse_type_name(std::string const& name, HD5_Type& type)
+{
+  if      (name == "float")  { type = H5_float; }
+  else if (name == "double") { type = H5_double; }
+  else if (name == "char")   { type = H5_char; }
+  else if (name == "uchar")  { type = H5_uchar; }
+  else if (name == "short")  { type = H5_short; }
+  else if (name == "ushort") { type = H5_ushort; }
+  else if (name == "int")    { type = H5_int; }
+  else if (name == "uint")   { type = H5_uint; }
+  else if (name == "long")   { type = H5_long; }
+  else if (name == "ulong")  { type = H5_ulong; }
+  else if (name == "half")   { type = H5_half; }
+  else {
+    return false;
+  }
+
+  return true;
+}
+
+
+bool check_device_type(char const* filename, char const* varname)
+{
+  return h5_check_attribute(filename, varname, "device_type");
+}
+
+
+bool read_device_type(char const* filename, char const* varname, HD5_Type& type)
+{
+  string name;
+  if (!h5_read_attribute_string(filename, varname, "device_type", name)) {
+    return false;
+  }
+
+  if (!parse_type_name(name, type)) {
+    cerr << ERROR_INFO << "Unknown device type '" << name << "' of '" << varname << "'." << endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+bool convert_buffer(void const* src, HD5_Type src_type, void* dst, HD5_Type dst_type, size_t num_elements)
+{
+  if (src_type == dst_type) {
+    memcpy(dst, src, num_elements * get_type_size(src_type));
+    return true;
+  }
+
+  // half precision is converted via single precision, in blocks fitting into the cache
+  if (src_type == H5_half || dst_type == H5_half) {
+    if (src_type == H5_compound || dst_type == H5_compound) {
+      cerr << ERROR_INFO << "Conversion from data type '" << src_type << "' to '" << dst_type << "' not supported." << endl;
+      return false;
+    }
+
+    size_t const src_size = get_type_size(src_type);
+    size_t const dst_size = get_type_size(dst_type);
+    cl_float block[1024];
+    for (size_t first = 0; first < num_elements; first += 1024) {
+      size_t num = std::min((size_t)1024, num_elements - first);
+      uint8_t const* src_block = (uint8_t const*)src + first * src_size;
+      uint8_t* dst_block = (uint8_t*)dst + first * dst_size;
+
+      if (src_type == H5_half) {
+        half_to_float_elements((cl_half const*)src_block, block, num);
+      }
+      else {
+        convert_buffer(src_block, src_type, block, H5_float, num);
+      }
+
+      if (dst_type == H5_half) {
+        float_to_half_elements(block, (cl_half*)dst_block, num);
+      }
+      else {
+        convert_buffer(block, H5_float, dst_block, dst_type, num);
+      }
+    }
+    return true;
+  }
+
+  bool success = false;
+  switch (src_type) {
+    case H5_float:  success = convert_from((cl_float const*)src,  dst, dst_type, num_elements); break;
+    case H5_double: success = convert_from((cl_double const*)src, dst, dst_type, num_elements); break;
+    case H5_char:   success = convert_from((cl_char const*)src,   dst, dst_type, num_elements); break;
+    case H5_uchar:  success = convert_from((cl_uchar const*)src,  dst, dst_type, num_elements); break;
+    case H5_short:  success = convert_from((cl_short const*)src,  dst, dst_type, num_elements); break;
+    case H5_ushort: success = convert_from((cl_ushort const*)src, dst, dst_type, num_elements); break;
+    case H5_int:    success = convert_from((cl_int const*)src,    dst, dst_type, num_elements); break;
+    case H5_uint:   success = convert_from((cl_uint const*)src,   dst, dst_type, num_elements); break;
+    case H5_long:   success = convert_from((cl_long const*)src,   dst, dst_type, num_elements); break;
+    case H5_ulong:  success = convert_from((cl_ulong const*)src,  dst, dst_type, num_elements); break;
+    case H5_half:
+    case H5_compound: break;
+  }
+
+  if (!success) {
+    cerr << ERROR_INFO << "Conversion from data type '" << src_type << "' to '" << dst_type << "' not supported." << endl;
+  }
+  return success;
+}
@@ -0,0 +1,122 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 32;
+
+  string filename{"access_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel
+  string kernel_url("access_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void scale(global int const* in, global int* out, global int* out_alias, global int* unused)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  out[gid] = 2 * in[gid];\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("scale"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data
+  vector<cl_int> in(LENGTH);
+  vector<cl_int> out(LENGTH, -1); // never uploaded since `out` is write only
+  vector<cl_int> unused(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    in.at(i) = i;
+    unused.at(i) = LENGTH - i;
+  }
+
+  h5_create_dir(filename, "/data");
+  h5_write_buffer<cl_int>(filename, "data/in", &in[0], LENGTH);
+  h5_write_buffer<cl_int>(filename, "data/out", &out[0], LENGTH);
+  h5_write_attribute_string(filename, "data/out", "access", "write_only");
+  h5_create_hard_link(filename, "data/out_alias", "data/out"); // shares the buffer of `out`
+  h5_write_buffer<cl_int>(filename, "data/unused", &unused[0], LENGTH);
+  h5_write_attribute_string(filename, "data/unused", "access", "read_only");
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+  vector<cl_int> in_test(LENGTH);
+  vector<cl_int> out_test(LENGTH);
+  vector<cl_int> unused_test(LENGTH);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  // read only buffers are linked to the input file
+  h5_read_buffer<cl_int>(out_filename, "data/in", &in_test[0]);
+  if (in_test != in) {
+    cerr << "Error: Result 'in' is not as expected." << endl;
+    return 1;
+  }
+
+  h5_read_buffer<cl_int>(out_filename, "data/unused", &unused_test[0]);
+  if (unused_test != unused) {
+    cerr << "Error: Result 'unused' is not as expected." << endl;
+    return 1;
+  }
+
+  h5_read_buffer<cl_int>(out_filename, "data/out", &out_test[0]);
+  for (int i = 0; i < LENGTH; ++i) {
+    if (out_test.at(i) != 2 * in.at(i)) {
+      cerr << "Error: Result 'out' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  vector<cl_int> out_alias_test(LENGTH);
+  h5_read_buffer<cl_int>(out_filename, "data/out_alias", &out_alias_test[0]);
+  if (out_alias_test != out_test) {
+    cerr << "Error: Result 'out_alias' is not as expected." << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,152 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+constexpr int LENGTH = 32;
+
+string filename{"cache_test.h5"};
+string out_filename{"out_cache_test.h5"};
+string log_filename{"cache_test.log"};
+
+
+// call toolkitICL with the result cache and check whether the output file is
+// taken from the cache and contains the values increased by `increment`
+bool run(string const& options, bool expect_hit, vector<cl_ulong> const& values, cl_ulong increment)
+{
+  string command("toolkitICL -c ");
+  command.append(filename).append(" -cache cache_test_cache ").append(options);
+  command.append(" > ").append(log_filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return false;
+  }
+
+  ifstream log_file(log_filename);
+  stringstream log;
+  log << log_file.rdbuf();
+  bool hit = log.str().find("taken from the result cache") != string::npos;
+  if (hit != expect_hit) {
+    cerr << "Error: The output file of `" << command << "` is " << (hit ? "" : "not ") << "taken from the result cache." << endl;
+    return false;
+  }
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return false;
+  }
+  vector<cl_ulong> values_test(LENGTH);
+  h5_read_buffer<cl_ulong>(out_filename, "/data/values", &values_test[0]);
+  for (size_t idx = 0; idx < LENGTH; ++idx) {
+    if (values_test[idx] != values[idx] + increment) {
+      cerr << "Error: Result 'values[" << idx << "] == " << values_test[idx] << "' of `" << command
+           << "` is not as expected [" << values[idx] + increment << "]." << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void write_header(cl_ulong increment)
+{
+  ofstream header_file("cache_test_increment.h");
+  header_file << "#define INCREMENT " << increment << endl;
+}
+
+
+int main(void)
+{
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel including a header
+  string kernel_url("cache_test_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+#include \"cache_test_increment.h\"\n\
+\n\
+kernel void add(global ulong* values)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  values[gid] += INCREMENT;\n\
+}\n\
+" << endl;
+  kernel_file.close();
+  write_header(1);
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "/settings/kernel_settings", "-I .");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("add"));
+  h5_write_strings(filename, "kernels", kernels);
+  h5_write_single<cl_ulong>(filename, "settings/kernel_repetitions", 1);
+
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "/settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "/settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "/settings/range_start", tmp_range, 3);
+
+  // entries of earlier runs of the test are not used, since the settings differ
+  cl_ulong nonce = chrono::system_clock::now().time_since_epoch().count();
+  h5_write_single<cl_ulong>(filename, "settings/cache_test_nonce", nonce);
+
+  vector<cl_ulong> values(LENGTH);
+  for (cl_ulong i = 0; i < LENGTH; ++i) {
+    values.at(i) = i;
+  }
+  h5_create_dir(filename, "/data");
+  h5_write_buffer<cl_ulong>(filename, "/data/values", &values[0], LENGTH);
+
+  // the first run executes the kernels and stores the output file
+  if (!run("", false, values, 1)) {
+    return 1;
+  }
+
+  // the second run takes it from the cache; modifying the output file in place
+  // does not change the cache entry
+  vector<cl_ulong> zeros(LENGTH, 0);
+  h5_write_buffer<cl_ulong>(out_filename, "/data/values", &zeros[0], LENGTH);
+  if (!run("", true, values, 1)) {
+    return 1;
+  }
+
+  // the kernels are executed with `-force` ...
+  if (!run("-force", false, values, 1)) {
+    return 1;
+  }
+
+  // ... if the included header changes ...
+  write_header(2);
+  if (!run("", false, values, 2) || !run("", true, values, 2)) {
+    return 1;
+  }
+
+  // ... and if the data change
+  for (cl_ulong i = 0; i < LENGTH; ++i) {
+    values.at(i) = 2 * i;
+  }
+  h5_write_buffer<cl_ulong>(filename, "/data/values", &values[0], LENGTH);
+  if (!run("", false, values, 2) || !run("", true, values, 2)) {
+    return 1;
+  }
+
+  return 0;
+}
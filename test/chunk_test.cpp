@@ -0,0 +1,132 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+// write `data` on `write_threads` threads and read it back on `read_threads` threads;
+// a single thread uses H5Dwrite and H5Dread of the HDF5 library
+bool round_trip(string const& filename, char const* varname, vector<float> const& data,
+                vector<size_t> const& dims, vector<size_t> const& chunk_dims,
+                unsigned int write_threads, unsigned int read_threads)
+{
+  h5_set_threads(write_threads);
+  if (!h5_write_buffer<float>(filename, varname, &data[0], dims, chunk_dims)) {
+    cerr << "Error: Could not write '" << varname << "'." << endl;
+    return false;
+  }
+
+  h5_set_threads(read_threads);
+  vector<float> data_test(data.size(), -1.0f);
+  if (!h5_read_buffer<float>(filename, varname, &data_test[0])) {
+    cerr << "Error: Could not read '" << varname << "'." << endl;
+    return false;
+  }
+
+  if (data_test != data) {
+    cerr << "Error: '" << varname << "' written on " << write_threads << " and read on "
+         << read_threads << " threads is not as expected." << endl;
+    return false;
+  }
+  return true;
+}
+
+
+// check that the chunks of a dataset written without chunk dimensions are of
+// `expected` dimensions, and not larger than `target` bytes but larger than half of it
+bool check_chunk_dims(string const& filename, char const* varname, vector<size_t> const& dims,
+                      size_t target, vector<hsize_t> const& expected)
+{
+  h5_set_chunk_size(target);
+  size_t size = 1;
+  for (size_t dim : dims) {
+    size *= dim;
+  }
+  vector<float> data(size, 1.0f);
+  h5_write_buffer<float>(filename, varname, &data[0], dims, vector<size_t>());
+
+  hid_t file_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t dataset_id = H5Dopen(file_id, varname, H5P_DEFAULT);
+  hid_t plist_id = H5Dget_create_plist(dataset_id);
+  vector<hsize_t> chunk_dims(dims.size(), 0);
+  bool chunked = H5Pget_layout(plist_id) == H5D_CHUNKED && H5Pget_chunk(plist_id, (int)dims.size(), &chunk_dims[0]) == (int)dims.size();
+  H5Pclose(plist_id);
+  H5Dclose(dataset_id);
+  H5Fclose(file_id);
+
+  size_t bytes = sizeof(float);
+  for (hsize_t dim : chunk_dims) {
+    bytes *= dim;
+  }
+  if (!chunked || chunk_dims != expected || bytes > target || (bytes <= target / 2 && bytes < size * sizeof(float))) {
+    cerr << "Error: The chunks of '" << varname << "' of " << bytes << " bytes are not as expected for a target of "
+         << target << " bytes." << endl;
+    return false;
+  }
+  return true;
+}
+
+
+int main(void)
+{
+  string filename{"chunk_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  H5_Compression compression;
+  h5_parse_compression("shuffle,deflate:1", compression);
+  h5_set_compression(compression);
+
+  // dimensions not divisible by the chunk dimensions, so the chunks at the edges are partial
+  vector<size_t> dims{301, 157}, chunk_dims{64, 50};
+  vector<float> data(dims[0] * dims[1]);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = 0.5f * (i % 977);
+  }
+
+  // many more chunks than chunks in flight
+  vector<size_t> dims_1d{100003}, chunk_dims_1d{1000};
+  vector<float> data_1d(dims_1d[0]);
+  for (size_t i = 0; i < data_1d.size(); ++i) {
+    data_1d[i] = 0.25f * (i % 4099);
+  }
+
+  if (!round_trip(filename, "parallel_write", data, dims, chunk_dims, 4, 1)
+      || !round_trip(filename, "parallel_read", data, dims, chunk_dims, 1, 4)
+      || !round_trip(filename, "parallel", data, dims, chunk_dims, 4, 4)
+      || !round_trip(filename, "parallel_write_1d", data_1d, dims_1d, chunk_dims_1d, 3, 1)
+      || !round_trip(filename, "parallel_read_1d", data_1d, dims_1d, chunk_dims_1d, 1, 3)) {
+    return 1;
+  }
+
+  // chunk dimensions derived from the target size: the largest dimension is
+  // halved, so chunks are blocks, while short trailing dimensions are kept whole
+  h5_parse_compression("none", compression);
+  h5_set_compression(compression);
+  h5_set_threads(1);
+  if (!check_chunk_dims(filename, "chunks_1d", {1000000}, 65536, {15625})
+      || !check_chunk_dims(filename, "chunks_2d", {3000, 4000}, 1 << 20, {375, 500})
+      || !check_chunk_dims(filename, "chunks_vector", {200000, 3}, 65536, {3125, 3})
+      || !check_chunk_dims(filename, "chunks_small", {100, 10}, 1 << 20, {100, 10})) {
+    return 1;
+  }
+
+  // targets beyond the limit of HDF5 are clamped to it
+  h5_set_chunk_size(8000000000ull);
+  if (h5_get_chunk_size() != ((size_t)1 << 32) - 1) {
+    cerr << "Error: The target chunk size " << h5_get_chunk_size() << " exceeds the limit of HDF5." << endl;
+    return 1;
+  }
+
+  return 0;
+}
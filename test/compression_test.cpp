@@ -0,0 +1,124 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+// get the filters of a dataset
+vector<H5Z_filter_t> get_filters(string const& filename, char const* varname)
+{
+  vector<H5Z_filter_t> filters;
+  hid_t file_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t dataset_id = H5Dopen(file_id, varname, H5P_DEFAULT);
+  hid_t plist_id = H5Dget_create_plist(dataset_id);
+  for (int idx = 0; idx < H5Pget_nfilters(plist_id); ++idx) {
+    unsigned int flags, cd_values[8];
+    size_t cd_nelmts = 8;
+    filters.push_back(H5Pget_filter2(plist_id, idx, &flags, &cd_nelmts, cd_values, 0, NULL, NULL));
+  }
+  H5Pclose(plist_id);
+  H5Dclose(dataset_id);
+  H5Fclose(file_id);
+  return filters;
+}
+
+
+int main(void)
+{
+  constexpr int LENGTH = 100000;
+
+  string filename{"compression_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // parsing
+  H5_Compression compression;
+  vector<string> valid{"none", "deflate", "deflate:1", "gzip:9", "shuffle,deflate:1", "scaleoffset", "scaleoffset:3",
+                       "filter:1", "filter:1:3", "filter:2,filter:1", "auto", "auto:50"};
+  for (string const& spec : valid) {
+    if (!h5_parse_compression(spec, compression)) {
+      cerr << "Error: Compression '" << spec << "' is not accepted." << endl;
+      return 1;
+    }
+  }
+  vector<string> invalid{"deflate:0", "deflate:10", "filter:1:0", "filter:1:3:4", "shuffle:1", "filter:2:1",
+                         "scaleoffset:1:2", "filter", "deflate:x", "unknown"};
+  for (string const& spec : invalid) {
+    if (h5_parse_compression(spec, compression)) {
+      cerr << "Error: Compression '" << spec << "' is accepted." << endl;
+      return 1;
+    }
+  }
+
+  h5_parse_compression("filter:1", compression);
+  if (compression.filters != vector<H5Z_filter_t>{H5Z_FILTER_DEFLATE} || compression.params.at(0) != vector<unsigned int>{6}) {
+    cerr << "Error: The default level of 'filter:1' is not as expected." << endl;
+    return 1;
+  }
+
+  // round trips of integer and floating point data
+  vector<cl_int> ints(LENGTH);
+  vector<float> floats(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    ints.at(i) = (i % 1000) - 500;
+    floats.at(i) = sin(0.001f * i);
+  }
+
+  vector<string> chains{"none", "deflate:1", "shuffle,deflate:1", "filter:1", "filter:2,filter:1:3", "scaleoffset",
+                        "scaleoffset:3", "shuffle,scaleoffset:4,deflate:9"};
+  vector<vector<H5Z_filter_t>> int_filters{
+    {}, {H5Z_FILTER_DEFLATE}, {H5Z_FILTER_SHUFFLE, H5Z_FILTER_DEFLATE}, {H5Z_FILTER_DEFLATE},
+    {H5Z_FILTER_SHUFFLE, H5Z_FILTER_DEFLATE}, {H5Z_FILTER_SCALEOFFSET}, {H5Z_FILTER_SCALEOFFSET},
+    {H5Z_FILTER_SHUFFLE, H5Z_FILTER_SCALEOFFSET, H5Z_FILTER_DEFLATE}};
+  vector<vector<H5Z_filter_t>> float_filters{
+    {}, {H5Z_FILTER_DEFLATE}, {H5Z_FILTER_SHUFFLE, H5Z_FILTER_DEFLATE}, {H5Z_FILTER_DEFLATE},
+    {H5Z_FILTER_SHUFFLE, H5Z_FILTER_DEFLATE}, {}, {H5Z_FILTER_SCALEOFFSET},
+    {H5Z_FILTER_SHUFFLE, H5Z_FILTER_SCALEOFFSET, H5Z_FILTER_DEFLATE}};
+
+  for (size_t idx = 0; idx < chains.size(); ++idx) {
+    string const& chain = chains.at(idx);
+    h5_parse_compression(chain, compression);
+    h5_set_compression(compression);
+
+    string int_name = "ints_" + to_string(idx), float_name = "floats_" + to_string(idx);
+    h5_write_buffer<cl_int>(filename, int_name.c_str(), &ints[0], LENGTH);
+    h5_write_buffer<float>(filename, float_name.c_str(), &floats[0], LENGTH);
+
+    if (get_filters(filename, int_name.c_str()) != int_filters.at(idx)
+        || get_filters(filename, float_name.c_str()) != float_filters.at(idx)) {
+      cerr << "Error: The filters of the compression '" << chain << "' are not as expected." << endl;
+      return 1;
+    }
+
+    vector<cl_int> ints_test(LENGTH);
+    vector<float> floats_test(LENGTH);
+    h5_read_buffer<cl_int>(filename, int_name.c_str(), &ints_test[0]);
+    h5_read_buffer<float>(filename, float_name.c_str(), &floats_test[0]);
+
+    if (ints_test != ints) {
+      cerr << "Error: Integers compressed by '" << chain << "' are not as expected." << endl;
+      return 1;
+    }
+    // scale-offset with `digits` keeps that many decimal digits of floating point values
+    float tolerance = chain.find("scaleoffset:") != string::npos ? 1.e-3f : 0.0f;
+    for (int i = 0; i < LENGTH; ++i) {
+      if (fabs(floats_test.at(i) - floats.at(i)) > tolerance) {
+        cerr << "Error: Floats compressed by '" << chain << "' are not as expected." << endl;
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
@@ -4,7 +4,12 @@
 #define COPYTYPE_CL float
 #include "copy_test.h"
 
-int main(void)
+// the command line arguments are passed to toolkitICL, e.g. `-huge_pages`
+int main(int argc, char* argv[])
 {
-  return runtest();
+  string options;
+  for (int arg_idx = 1; arg_idx < argc; ++arg_idx) {
+    options.append(arg_idx > 1 ? " " : "").append(argv[arg_idx]);
+  }
+  return runtest(options);
 }
@@ -15,7 +15,8 @@
 using namespace std;
 
 
-int runtest(void)
+// copy a buffer by toolkitICL called with the command line options `options`
+int runtest(string const& options = "")
 {
   constexpr int LENGTH = 32;
 
@@ -83,6 +84,9 @@ kernel void copy(global COPYTYPE const* in, global COPYTYPE* out)\n\
   // call toolkitICL
   string command("toolkitICL -c ");
   command.append(filename);
+  if (!options.empty()) {
+    command.append(" ").append(options);
+  }
   int retval = system(command.c_str());
   if (retval) {
     cerr << "Error: " << retval << endl;
@@ -0,0 +1,120 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <iostream>
+#include <string>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 64;
+
+  // the configuration file and the data files are in a directory, so that the
+  // relative data URL is resolved from the directory of the configuration file
+  string directory{"data_url_test_dir"};
+#if defined(_WIN32)
+  _mkdir(directory.c_str());
+#else
+  mkdir(directory.c_str(), 0755);
+#endif
+  string filename = directory + "/data_url_test.h5";
+  string data_filename = directory + "/data_url_test_data.h5";
+  string linked_filename = directory + "/data_url_test_linked.h5";
+  string out_filename{"out_data_url_test.h5"};
+
+  for (string const& name : {filename, data_filename, linked_filename, out_filename}) {
+    if (fileExists(name)) {
+      remove(name.c_str());
+    }
+  }
+
+  // kernel: `c` is bound after `a` and `b` in the order of the names
+  vector<string> kernel_source{"kernel void add(global int* a, global int* b, global int* c)",
+                               "{",
+                               "  const int gid = get_global_id(0);",
+                               "  c[gid] += a[gid] + b[gid];",
+                               "}"};
+  h5_write_strings(filename, "kernel_source", kernel_source);
+  vector<string> kernels(1, string("add"));
+  h5_write_strings(filename, "kernels", kernels);
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "/settings/kernel_settings", "");
+  h5_write_single<cl_ulong>(filename, "settings/kernel_repetitions", 1);
+  h5_write_string(filename, "/settings/data_url", "data_url_test_data.h5");
+
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "/settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "/settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "/settings/range_start", tmp_range, 3);
+
+  vector<cl_int> a(LENGTH), b(LENGTH), c(LENGTH), shadowed_c(LENGTH, -7777);
+  for (int i = 0; i < LENGTH; ++i) {
+    a.at(i) = i;
+    b.at(i) = 100 * i;
+    c.at(i) = 10000 * i;
+  }
+
+  // `a` is an external link to a third file, `b` is in the data file only, and
+  // `c` of the configuration file shadows `c` of the data file
+  h5_create_dir(linked_filename, "/data");
+  h5_write_buffer<cl_int>(linked_filename, "/data/a", &a[0], LENGTH);
+  h5_create_dir(data_filename, "/data");
+  h5_write_buffer<cl_int>(data_filename, "/data/b", &b[0], LENGTH);
+  h5_write_buffer<cl_int>(data_filename, "/data/c", &shadowed_c[0], LENGTH);
+  h5_create_dir(filename, "/data");
+  h5_create_external_link(filename, "/data/a", "data_url_test_linked.h5", "/data/a");
+  h5_write_buffer<cl_int>(filename, "/data/c", &c[0], LENGTH);
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  vector<cl_int> c_test(LENGTH);
+  h5_read_buffer<cl_int>(out_filename, "/data/c", &c_test[0]);
+  for (size_t idx = 0; idx < LENGTH; ++idx) {
+    cl_int expected = c[idx] + a[idx] + b[idx];
+    if (c_test[idx] != expected) {
+      cerr << "Error: Result 'c[" << idx << "] == " << c_test[idx] << "' is not as expected [" << expected << "]." << endl;
+      return 1;
+    }
+  }
+
+  // the data files are unchanged
+  vector<cl_int> b_test(LENGTH), shadowed_c_test(LENGTH);
+  h5_read_buffer<cl_int>(data_filename, "/data/b", &b_test[0]);
+  h5_read_buffer<cl_int>(data_filename, "/data/c", &shadowed_c_test[0]);
+  if (b_test != b || shadowed_c_test != shadowed_c) {
+    cerr << "Error: The data file has been modified." << endl;
+    return 1;
+  }
+
+  return 0;
+}
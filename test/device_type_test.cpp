@@ -0,0 +1,114 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 32;
+
+  string filename{"device_type_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel; `x` is stored as double and `n` as int, but used as float and short
+  string kernel_url("device_type_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void scale(global short* n, global float* x)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  x[gid] *= 2.0f;\n\
+  n[gid] += 1;\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("scale"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data
+  vector<double> x(LENGTH);
+  vector<cl_int> n(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    x.at(i) = 0.25 * i;
+    n.at(i) = 1000 * i;
+  }
+
+  h5_create_dir(filename, "/data");
+  h5_write_buffer<double>(filename, "data/x", &x[0], LENGTH);
+  h5_write_buffer<cl_int>(filename, "data/n", &n[0], LENGTH);
+  h5_write_attribute_string(filename, "data/x", "device_type", "float");
+  h5_write_attribute_string(filename, "data/n", "device_type", "short");
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  // the results are stored using the types of the input file
+  vector<string> names;
+  vector<HD5_Type> types;
+  vector<size_t> sizes;
+  h5_get_content(out_filename.c_str(), "/data/", names, types, sizes);
+  if (names.size() != 2 || types.at(0) != H5_int || types.at(1) != H5_double) {
+    cerr << "Error: Output types are not as expected." << endl;
+    return 1;
+  }
+
+  vector<double> x_test(LENGTH);
+  vector<cl_int> n_test(LENGTH);
+  h5_read_buffer<double>(out_filename, "data/x", &x_test[0]);
+  h5_read_buffer<cl_int>(out_filename, "data/n", &n_test[0]);
+  for (int i = 0; i < LENGTH; ++i) {
+    if (x_test.at(i) != 2 * x.at(i)) {
+      cerr << "Error: Result 'x' is not as expected." << endl;
+      return 1;
+    }
+    if (n_test.at(i) != n.at(i) + 1) {
+      cerr << "Error: Result 'n' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 32;
+
+  string filename{"fill_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel
+  string kernel_url("fill_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void add(global float const* in, global float* out)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  out[gid] += in[gid];\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("add"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data; `out` is declared only by its size and fill value
+  vector<float> in(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    in.at(i) = i;
+  }
+  float fill_value = 0.5f;
+
+  h5_create_dir(filename, "/data");
+  h5_write_buffer<float>(filename, "data/in", &in[0], LENGTH);
+  h5_create_buffer<float>(filename, "data/out", LENGTH, fill_value);
+
+  if (!h5_check_fill_value(filename, "data/out") || h5_check_fill_value(filename, "data/in")) {
+    cerr << "Error: Fill values are not detected as expected." << endl;
+    return 1;
+  }
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+  vector<float> out_test(LENGTH);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  h5_read_buffer<float>(out_filename, "data/out", &out_test[0]);
+  for (int i = 0; i < LENGTH; ++i) {
+    if (out_test.at(i) != in.at(i) + fill_value) {
+      cerr << "Error: Result 'out' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
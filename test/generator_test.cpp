@@ -0,0 +1,139 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+// reference implementation of the random number generator Philox4x32-10
+void philox4x32_10(cl_ulong idx, cl_ulong seed, cl_uint r[4])
+{
+  cl_uint ctr[4] = { (cl_uint)idx, (cl_uint)(idx >> 32), 0, 0 };
+  cl_uint key[2] = { (cl_uint)seed, (cl_uint)(seed >> 32) };
+
+  for (int round = 0; round < 10; ++round) {
+    cl_ulong prod0 = (cl_ulong)0xD2511F53u * ctr[0];
+    cl_ulong prod1 = (cl_ulong)0xCD9E8D57u * ctr[2];
+    cl_uint tmp[4] = { (cl_uint)(prod1 >> 32) ^ ctr[1] ^ key[0], (cl_uint)prod1,
+                       (cl_uint)(prod0 >> 32) ^ ctr[3] ^ key[1], (cl_uint)prod0 };
+    copy(tmp, tmp + 4, ctr);
+    key[0] += 0x9E3779B9u;
+    key[1] += 0xBB67AE85u;
+  }
+
+  copy(ctr, ctr + 4, r);
+}
+
+
+int main(void)
+{
+  constexpr int LENGTH = 1024;
+
+  string filename{"generator_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel
+  string kernel_url("generator_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void copy(global int const* a_iota, global float const* b_uniform,\n\
+                 global int* c_iota_out, global float* d_uniform_out)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  c_iota_out[gid] = a_iota[gid];\n\
+  d_uniform_out[gid] = b_uniform[gid];\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("copy"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data; only the generator settings are stored in the input file
+  cl_ulong seed = 42;
+  h5_create_dir(filename, "/data");
+  h5_create_buffer<cl_int>(filename, "data/a_iota", LENGTH, 0);
+  h5_write_attribute_string(filename, "data/a_iota", "generator", "iota");
+  h5_write_attribute<cl_int>(filename, "data/a_iota", "start", 5);
+
+  h5_create_buffer<float>(filename, "data/b_uniform", LENGTH, 0.0f);
+  h5_write_attribute_string(filename, "data/b_uniform", "generator", "uniform");
+  h5_write_attribute<cl_ulong>(filename, "data/b_uniform", "seed", seed);
+  h5_write_attribute<double>(filename, "data/b_uniform", "min", -1.0);
+  h5_write_attribute<double>(filename, "data/b_uniform", "max", 1.0);
+
+  h5_create_buffer<cl_int>(filename, "data/c_iota_out", LENGTH, 0);
+  h5_create_buffer<float>(filename, "data/d_uniform_out", LENGTH, 0.0f);
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+  vector<cl_int> iota_test(LENGTH);
+  vector<float> uniform_test(LENGTH);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  if (h5_check_object(out_filename.c_str(), "data/a_iota") || h5_check_object(out_filename.c_str(), "data/b_uniform")) {
+    cerr << "Error: Generated read only buffers should not be stored." << endl;
+    return 1;
+  }
+
+  h5_read_buffer<cl_int>(out_filename, "data/c_iota_out", &iota_test[0]);
+  for (int i = 0; i < LENGTH; ++i) {
+    if (iota_test.at(i) != 5 + i) {
+      cerr << "Error: Result 'c_iota_out' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  h5_read_buffer<float>(out_filename, "data/d_uniform_out", &uniform_test[0]);
+  for (int i = 0; i < LENGTH; ++i) {
+    cl_uint r[4];
+    philox4x32_10(i, seed, r);
+    float expected = -1.0f + 2.0f * ((r[0] >> 8) / 16777216.0f);
+    if (fabs(uniform_test.at(i) - expected) > 1.e-6f) {
+      cerr << "Error: Result 'd_uniform_out' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 32;
+
+  string filename{"half_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel; vload_half and vstore_half do not require the extension cl_khr_fp16
+  string kernel_url("half_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void twice(global half* x)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  vstore_half(2.0f * vload_half(gid, x), gid, x);\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("twice"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data; stored as 16 bit floating point values
+  vector<float> x(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    x.at(i) = 0.5f * i;
+  }
+
+  h5_create_dir(filename, "/data");
+  hid_t h5_file_id = H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  hsize_t dims[1] = { LENGTH };
+  hid_t dataspace = H5Screate_simple(1, dims, NULL);
+  hid_t dataset = H5Dcreate2(h5_file_id, "data/x", type_to_h5_type(H5_half), dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  H5Dwrite(dataset, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &x[0]);
+  H5Dclose(dataset);
+  H5Sclose(dataspace);
+  H5Fclose(h5_file_id);
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  vector<string> names;
+  vector<HD5_Type> types;
+  vector<size_t> sizes;
+  h5_get_content(out_filename.c_str(), "/data/", names, types, sizes);
+  if (names.size() != 1 || types.at(0) != H5_half) {
+    cerr << "Error: Output type is not as expected." << endl;
+    return 1;
+  }
+
+  vector<float> x_test(LENGTH);
+  h5_read_buffer<float>(out_filename, "data/x", &x_test[0]);
+  for (int i = 0; i < LENGTH; ++i) {
+    if (x_test.at(i) != 2.0f * x.at(i)) {
+      cerr << "Error: Result 'x' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
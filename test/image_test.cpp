@@ -0,0 +1,101 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int WIDTH = 16;
+  constexpr int HEIGHT = 8;
+
+  string filename{"image_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel; `in` is an image with four channels, `out` a buffer
+  string kernel_url("image_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+constant sampler_t sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;\n\
+\n\
+kernel void sum(read_only image2d_t in, global float* out)\n\
+{\n\
+  const int x = get_global_id(0);\n\
+  const int y = get_global_id(1);\n\
+  float4 pixel = read_imagef(in, sampler, (int2)(x, y));\n\
+  out[y * get_global_size(0) + x] = pixel.x + pixel.y + pixel.z + pixel.w;\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("sum"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = WIDTH; tmp_range[1] = HEIGHT; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data; the image has the dimensions height x width x channels
+  vector<float> in(HEIGHT * WIDTH * 4);
+  vector<float> out(HEIGHT * WIDTH, 0.0f);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in.at(i) = 0.25f * i;
+  }
+
+  h5_create_dir(filename, "/data");
+  h5_write_buffer<float>(filename, "data/in", &in[0], {HEIGHT, WIDTH, 4}, {});
+  h5_write_buffer<float>(filename, "data/out", &out[0], {HEIGHT, WIDTH}, {});
+  h5_write_attribute_string(filename, "data/in", "image_channel_order", "RGBA");
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  vector<float> out_test(HEIGHT * WIDTH);
+  h5_read_buffer<float>(out_filename, "data/out", &out_test[0]);
+  for (int i = 0; i < HEIGHT * WIDTH; ++i) {
+    float expected = in.at(4 * i) + in.at(4 * i + 1) + in.at(4 * i + 2) + in.at(4 * i + 3);
+    if (out_test.at(i) != expected) {
+      cerr << "Error: Result 'out' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 1000;
+
+  string filename{"link_test.h5"};
+  string shared_filename{"link_test_shared.h5"};
+
+  for (string const& name : {filename, shared_filename}) {
+    if (fileExists(name)) {
+      remove(name.c_str());
+    }
+  }
+
+  // a contiguous dataset in the shared file
+  vector<cl_int> values(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    values.at(i) = 3 * i - 100;
+  }
+  h5_create_dir(shared_filename, "/data");
+  hid_t file_id = H5Fopen(shared_filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  hsize_t dims[1] = {LENGTH};
+  H5LTmake_dataset_int(file_id, "/data/x", 1, dims, &values[0]);
+  H5Fclose(file_id);
+
+  // the configuration file links to it
+  h5_create_dir(filename, "/data");
+  if (!h5_create_external_link(filename, "/data/x", shared_filename.c_str(), "/data/x")) {
+    cerr << "Error: Could not create the external link '/data/x'." << endl;
+    return 1;
+  }
+
+  // the content of the configuration file includes the linked dataset
+  vector<string> data_names;
+  vector<HD5_Type> data_types;
+  vector<size_t> data_sizes;
+  vector<vector<size_t>> data_dims;
+  h5_get_content(filename.c_str(), "/data/", data_names, data_types, data_sizes, data_dims);
+  if (data_names != vector<string>{"/data/x"} || data_types.at(0) != H5_int || data_sizes.at(0) != LENGTH
+      || data_dims.at(0) != vector<size_t>{LENGTH}) {
+    cerr << "Error: The content of '" << filename << "' does not include the linked dataset." << endl;
+    return 1;
+  }
+
+  vector<cl_int> values_test(LENGTH);
+  if (!h5_read_buffer<cl_int>(filename, "/data/x", &values_test[0]) || values_test != values) {
+    cerr << "Error: Data read through the external link are not as expected." << endl;
+    return 1;
+  }
+
+  // the raw data are located in the shared file
+  string data_filename;
+  size_t offset = 0, size = 0;
+  if (!h5_get_raw_data_offset(filename, "/data/x", data_filename, offset, size)) {
+    cerr << "Error: No raw data offset of the linked dataset." << endl;
+    return 1;
+  }
+  if (data_filename.find(shared_filename) == string::npos || size != LENGTH * sizeof(cl_int)) {
+    cerr << "Error: The raw data of the linked dataset are reported in '" << data_filename << "' with size " << size << "." << endl;
+    return 1;
+  }
+  ifstream shared_file(data_filename, ios::binary);
+  shared_file.seekg(offset);
+  shared_file.read((char*)&values_test[0], size);
+  if (!shared_file || values_test != values) {
+    cerr << "Error: The raw data at offset " << offset << " of '" << data_filename << "' are not as expected." << endl;
+    return 1;
+  }
+
+  return 0;
+}
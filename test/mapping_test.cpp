@@ -0,0 +1,76 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+#include "file_mapping.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 100000;
+
+  string filename{"mapping_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  vector<double> values(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    values.at(i) = 0.25 * i - 1000.0;
+  }
+
+  // a contiguous dataset, as created by h5py without chunks or compression, and a chunked one
+  h5_create_dir(filename, "/data");
+  hid_t file_id = H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  hsize_t dims[1] = {LENGTH};
+  H5LTmake_dataset_double(file_id, "/data/contiguous", 1, dims, &values[0]);
+  H5Fclose(file_id);
+  h5_write_buffer<double>(filename, "/data/chunked", &values[0], LENGTH);
+
+  string data_filename;
+  size_t offset = 0, size = 0;
+  if (h5_get_raw_data_offset(filename, "/data/chunked", data_filename, offset, size)) {
+    cerr << "Error: A raw data offset of the chunked dataset is reported." << endl;
+    return 1;
+  }
+  if (!h5_get_raw_data_offset(filename, "/data/contiguous", data_filename, offset, size) || size != LENGTH * sizeof(double)) {
+    cerr << "Error: No raw data offset of the contiguous dataset." << endl;
+    return 1;
+  }
+
+  // the mapped data equal the data read by HDF5
+  vector<double> values_test(LENGTH);
+  h5_read_buffer<double>(filename, "/data/contiguous", &values_test[0]);
+
+  file_mapper mapper;
+  uint8_t* mapped = mapper.map(data_filename.c_str(), offset, size);
+  if (mapped == nullptr) {
+    cerr << "Error: Could not map " << size << " bytes at offset " << offset << " of '" << data_filename << "'." << endl;
+    return 1;
+  }
+  if (values_test != values || memcmp(mapped, &values_test[0], size) != 0) {
+    cerr << "Error: The mapped data are not as expected." << endl;
+    return 1;
+  }
+
+  // the mapping is private, so the file is not modified
+  memset(mapped, 0, size);
+  mapper.unmap(mapped);
+  h5_read_buffer<double>(filename, "/data/contiguous", &values_test[0]);
+  if (values_test != values) {
+    cerr << "Error: The file has been modified through the mapping." << endl;
+    return 1;
+  }
+
+  return 0;
+}
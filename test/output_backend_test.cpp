@@ -0,0 +1,280 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+#include "output_backend.hpp"
+
+
+using namespace std;
+
+
+// check the header of a .npy file of version 1.0 and return the offset of the data
+size_t check_npy_header(string const& header, string const& descr, string const& shape)
+{
+  if (header.size() < 10 || header.compare(0, 8, string("\x93NUMPY\x01\x00", 8)) != 0) {
+    cerr << "Error: The .npy header does not start with the magic string and version 1.0." << endl;
+    return 0;
+  }
+  size_t offset = 10 + (uint8_t)header[8] + 256 * (size_t)(uint8_t)header[9];
+  string dict = header.substr(10, offset - 10);
+  if (offset % 4096 != 0 || offset > header.size() || dict.back() != '\n') {
+    cerr << "Error: The .npy header is not padded to a multiple of 4096 bytes." << endl;
+    return 0;
+  }
+  if (dict.find("'descr': '" + descr + "'") == string::npos || dict.find("'fortran_order': False") == string::npos
+      || dict.find("'shape': " + shape) == string::npos) {
+    cerr << "Error: The .npy header '" << dict.substr(0, dict.find('}') + 1) << "' is not as expected." << endl;
+    return 0;
+  }
+  return offset;
+}
+
+
+// `.npy` files next to the output file, read through external datasets
+bool test_npy(string const& filename)
+{
+  vector<size_t> dims{37, 5};
+  vector<float> data(dims[0] * dims[1]);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = 0.5f * i;
+  }
+
+  std::unique_ptr<output_backend> backend = create_output_backend("npy", filename, 0);
+  if (!backend || !backend->write_buffer("/data/x", H5_float, &data[0], dims, vector<size_t>())) {
+    cerr << "Error: Could not write '/data/x' as .npy file." << endl;
+    return false;
+  }
+
+  string npy_filename = "output_backend_test.data_x.npy";
+  ifstream file(npy_filename, ios::binary);
+  string contents((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+  size_t offset = check_npy_header(contents, "<f4", "(37, 5)");
+  if (offset == 0 || contents.size() != offset + data.size() * sizeof(float)
+      || memcmp(&contents[offset], &data[0], data.size() * sizeof(float)) != 0) {
+    cerr << "Error: The file '" << npy_filename << "' is not as expected." << endl;
+    return false;
+  }
+
+  // the external storage of the dataset starts at the data of the .npy file
+  hid_t file_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t dataset_id = H5Dopen(file_id, "/data/x", H5P_DEFAULT);
+  hid_t plist_id = H5Dget_create_plist(dataset_id);
+  char external_name[256] = "";
+  off_t external_offset = 0;
+  hsize_t external_size = 0;
+  bool external = H5Pget_external_count(plist_id) == 1
+    && H5Pget_external(plist_id, 0, sizeof(external_name), external_name, &external_offset, &external_size) >= 0;
+  H5Pclose(plist_id);
+  H5Dclose(dataset_id);
+  H5Fclose(file_id);
+
+  // stored by name, i.e. relative to the output file
+  if (!external || string(external_name) != npy_filename || (size_t)external_offset != offset
+      || external_size != data.size() * sizeof(float)) {
+    cerr << "Error: The external storage of '/data/x' does not match the file '" << npy_filename << "'." << endl;
+    return false;
+  }
+
+  vector<float> data_test(data.size(), -1.0f);
+  if (!h5_read_buffer<float>(filename, "/data/x", &data_test[0]) || data_test != data) {
+    cerr << "Error: Data read through the external dataset '/data/x' are not as expected." << endl;
+    return false;
+  }
+
+#if !defined(_WIN32)
+  // the .npy file is found from another working directory, too
+  char cwd[4096] = "";
+  if (getcwd(cwd, sizeof(cwd)) == nullptr || chdir("/") != 0) {
+    cerr << "Error: Could not change the working directory." << endl;
+    return false;
+  }
+  data_test.assign(data.size(), -1.0f);
+  bool success = h5_read_buffer<float>(string(cwd) + "/" + filename, "/data/x", &data_test[0]);
+  if (chdir(cwd) != 0 || !success || data_test != data) {
+    cerr << "Error: Data read through '/data/x' from another directory are not as expected." << endl;
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+
+#if !defined(_WIN32)
+// shared memory segments with the layout of .npy files, described in the output file
+bool test_shm(string const& filename)
+{
+  // segments of earlier runs are removed when the backend is created
+  string stale_segment = "/output_backend_test.data_stale";
+  int fd = shm_open(stale_segment.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  vector<size_t> dims{100};
+  vector<cl_int> data(dims[0]);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = (cl_int)(i * i) - 500;
+  }
+
+  std::unique_ptr<output_backend> backend = create_output_backend("shm", filename, 0);
+  bool success = backend && backend->write_buffer("/data/y", H5_int, &data[0], dims, vector<size_t>());
+
+  fd = shm_open(stale_segment.c_str(), O_RDONLY, 0);
+  if (fd >= 0) {
+    close(fd);
+    shm_unlink(stale_segment.c_str());
+    cerr << "Error: The segment '" << stale_segment << "' of an earlier run is not removed." << endl;
+    return false;
+  }
+  if (!success) {
+    cerr << "Error: Could not write '/data/y' to shared memory." << endl;
+    return false;
+  }
+
+  // the descriptor dataset
+  string segment, dtype, shape;
+  if (!h5_read_string(filename.c_str(), "/data/y", segment)
+      || !h5_read_attribute_string(filename, "/data/y", "dtype", dtype)
+      || !h5_read_attribute_string(filename, "/data/y", "shape", shape)) {
+    cerr << "Error: Could not read the descriptor of '/data/y'." << endl;
+    return false;
+  }
+  segment = segment.c_str(); // without the terminating null character of the fixed length string
+  uint16_t probe = 1;
+  string expected_dtype = (*(uint8_t*)&probe == 1) ? "<i4" : ">i4";
+  if (segment != "/output_backend_test.data_y" || dtype != expected_dtype || shape != "(100,)") {
+    cerr << "Error: The descriptor of '/data/y' (" << segment << ", " << dtype << ", " << shape << ") is not as expected." << endl;
+    return false;
+  }
+
+  // the segment
+  fd = shm_open(segment.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    cerr << "Error: The segment '" << segment << "' does not exist." << endl;
+    return false;
+  }
+  struct stat segment_stat;
+  fstat(fd, &segment_stat);
+  size_t size = (size_t)segment_stat.st_size;
+  void* ptr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  shm_unlink(segment.c_str());
+  if (ptr == MAP_FAILED) {
+    cerr << "Error: Could not map the segment '" << segment << "'." << endl;
+    return false;
+  }
+  string contents((char const*)ptr, size);
+  munmap(ptr, size);
+
+  size_t offset = check_npy_header(contents, expected_dtype, "(100,)");
+  if (offset == 0 || size != offset + data.size() * sizeof(cl_int)
+      || memcmp(&contents[offset], &data[0], data.size() * sizeof(cl_int)) != 0) {
+    cerr << "Error: The segment '" << segment << "' is not as expected." << endl;
+    return false;
+  }
+
+  return true;
+}
+#endif
+
+
+// read only inputs are copied to the output file, or linked to the input file by its absolute path
+bool test_inputs(string const& filename)
+{
+  string input_filename = "output_backend_test_input.h5";
+  if (fileExists(input_filename)) {
+    remove(input_filename.c_str());
+  }
+  vector<double> data{1.0, 2.0, 3.0, 4.0};
+  h5_create_dir(input_filename, "/data");
+  h5_create_dir(input_filename, "/data/m");
+  h5_write_buffer<double>(input_filename, "/data/a", &data[0], data.size());
+  h5_write_buffer<double>(input_filename, "/data/b", &data[0], data.size());
+  h5_write_buffer<double>(input_filename, "/data/m/values", &data[0], data.size());
+
+  std::unique_ptr<output_backend> backend = create_output_backend("hdf5", filename, 0);
+  if (!backend || !backend->copy_input("/data/a", input_filename.c_str()) || !backend->copy_input("/data/m", input_filename.c_str())
+      || !backend->link_input("/data/b", input_filename.c_str())) {
+    cerr << "Error: Could not store the inputs in the output file." << endl;
+    return false;
+  }
+
+  hid_t file_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  H5L_info_t info_a, info_m, info_b;
+  bool found = H5Lget_info(file_id, "/data/a", &info_a, H5P_DEFAULT) >= 0
+    && H5Lget_info(file_id, "/data/m", &info_m, H5P_DEFAULT) >= 0
+    && H5Lget_info(file_id, "/data/b", &info_b, H5P_DEFAULT) >= 0;
+  string link_target;
+  if (found && info_b.type == H5L_TYPE_EXTERNAL) {
+    vector<char> value(info_b.u.val_size);
+    char const* target_filename = nullptr;
+    char const* target_varname = nullptr;
+    unsigned flags = 0;
+    H5Lget_val(file_id, "/data/b", &value[0], value.size(), H5P_DEFAULT);
+    H5Lunpack_elink_val(&value[0], value.size(), &flags, &target_filename, &target_varname);
+    link_target = target_filename;
+  }
+  H5Fclose(file_id);
+
+  if (!found || info_a.type != H5L_TYPE_HARD || info_m.type != H5L_TYPE_HARD || info_b.type != H5L_TYPE_EXTERNAL) {
+    cerr << "Error: The inputs are not stored as copies and a link." << endl;
+    return false;
+  }
+  if (link_target != h5_absolute_path(input_filename.c_str()) || link_target.find(input_filename) == 0) {
+    cerr << "Error: The link refers to '" << link_target << "' instead of the absolute path of the input file." << endl;
+    return false;
+  }
+
+  // the copies remain when the input file is gone
+  remove(input_filename.c_str());
+  vector<double> data_a(data.size(), 0.0);
+  vector<double> data_m(data.size(), 0.0);
+  if (!h5_read_buffer<double>(filename, "/data/a", &data_a[0]) || data_a != data
+      || !h5_read_buffer<double>(filename, "/data/m/values", &data_m[0]) || data_m != data) {
+    cerr << "Error: The copies of the inputs are not as expected." << endl;
+    return false;
+  }
+
+  return true;
+}
+
+
+int main(void)
+{
+  string filename{"output_backend_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+  h5_create_dir(filename, "/data");
+
+  if (!test_npy(filename)) {
+    return 1;
+  }
+  if (!test_inputs(filename)) {
+    return 1;
+  }
+#if !defined(_WIN32)
+  if (!test_shm(filename)) {
+    return 1;
+  }
+#endif
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 32;
+
+  string base_filename{"overlay_test_base.h5"};
+  string filename{"overlay_test.h5"};
+
+  for (string const& name : {base_filename, filename}) {
+    if (fileExists(name)) {
+      remove(name.c_str());
+    }
+  }
+
+  // kernel
+  string kernel_url("add_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void add(global ulong* values)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  values[gid] += INCREMENT;\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  // base: kernels, settings and data
+  h5_create_dir(base_filename, "settings");
+  h5_write_string(base_filename, "/settings/kernel_settings", "-DINCREMENT=1");
+  h5_write_string(base_filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("add"));
+  h5_write_strings(base_filename, "kernels", kernels);
+  h5_write_single<cl_ulong>(base_filename, "settings/kernel_repetitions", 1);
+
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(base_filename, "/settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(base_filename, "/settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(base_filename, "/settings/range_start", tmp_range, 3);
+
+  vector<cl_ulong> values(LENGTH);
+  for (cl_ulong i = 0; i < LENGTH; ++i) {
+    values.at(i) = i;
+  }
+
+  h5_create_dir(base_filename, "/data");
+  h5_write_buffer<cl_ulong>(base_filename, "/data/values", &values[0], LENGTH);
+
+  // overlay: only the kernel settings
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "/settings/kernel_settings", "-DINCREMENT=2");
+
+
+  // call toolkitICL with the overlay on top of the base and the repetitions set on the command line
+  cl_ulong kernel_repetitions = 3;
+  string command("toolkitICL -c ");
+  command.append(base_filename).append(" -c ").append(filename);
+  command.append(" -set settings/kernel_repetitions=").append(to_string(kernel_repetitions));
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+  vector<cl_ulong> values_test(LENGTH);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  h5_read_buffer<cl_ulong>(out_filename, "/data/values", &values_test[0]);
+  for (size_t idx = 0; idx < LENGTH; ++idx) {
+    if (values_test[idx] != values[idx] + 2 * kernel_repetitions) {
+      cerr << "Error: Result 'values[" << idx << "] == " << values_test[idx] << "' is not as expected [" << values[idx] + 2 * kernel_repetitions << "]." << endl;
+      return 1;
+    }
+  }
+
+  // the base file is unchanged
+  if (h5_read_single<cl_ulong>(base_filename, "settings/kernel_repetitions") != 1) {
+    cerr << "Error: The base configuration file has been modified." << endl;
+    return 1;
+  }
+
+  // the output file records the configuration files
+  vector<string> config_files;
+  h5_read_strings(out_filename, "/settings/config_files", config_files);
+  if (config_files.size() != 2 || config_files.at(0) != base_filename || config_files.at(1) != filename) {
+    cerr << "Error: The configuration files are not recorded in the output file." << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 64;
+
+  string filename{"selection_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel
+  string kernel_url("selection_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void index(global int* out, global int* skipped)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  out[gid] = 3 * gid;\n\
+  skipped[gid] = gid;\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("index"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data
+  constexpr cl_ulong OFFSET = 3;
+  constexpr cl_ulong STRIDE = 4;
+  constexpr cl_ulong COUNT = 10;
+
+  h5_create_dir(filename, "/data");
+  h5_create_buffer<cl_int>(filename, "data/out", LENGTH, 0);
+  h5_write_attribute<cl_ulong>(filename, "data/out", "output_offset", OFFSET);
+  h5_write_attribute<cl_ulong>(filename, "data/out", "output_stride", STRIDE);
+  h5_write_attribute<cl_ulong>(filename, "data/out", "output_count", COUNT);
+  h5_create_buffer<cl_int>(filename, "data/skipped", LENGTH, 0);
+  h5_write_attribute<cl_ulong>(filename, "data/skipped", "output_count", 0);
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  vector<size_t> dims;
+  h5_get_dims(out_filename, "data/out", dims);
+  if (dims.size() != 1 || dims.at(0) != COUNT) {
+    cerr << "Error: Size of 'out' is not as expected." << endl;
+    return 1;
+  }
+
+  vector<cl_int> out_test(COUNT);
+  h5_read_buffer<cl_int>(out_filename, "data/out", &out_test[0]);
+  for (cl_ulong i = 0; i < COUNT; ++i) {
+    if (out_test.at(i) != (cl_int)(3 * (OFFSET + i * STRIDE))) {
+      cerr << "Error: Result 'out' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  // empty selections are not stored
+  if (h5_check_object(out_filename.c_str(), "data/skipped")) {
+    cerr << "Error: Result 'skipped' should not be stored." << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,69 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 32;
+
+  string filename{"session_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  vector<cl_int> values(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    values.at(i) = i;
+  }
+
+  {
+    h5_file_session session(filename, true);
+
+    // all spellings of the file name use the session
+    if (!h5_has_session(filename.c_str()) || !h5_has_session(("./" + filename).c_str())) {
+      cerr << "Error: The session of '" << filename << "' is not found." << endl;
+      return 1;
+    }
+
+    // data written using another spelling are visible through the open file
+    h5_create_dir("./" + filename, "data");
+    h5_write_buffer<cl_int>("./" + filename, "data/values", &values[0], LENGTH);
+    vector<cl_int> values_test(LENGTH);
+    h5_read_buffer<cl_int>(filename, "data/values", &values_test[0]);
+    if (values_test != values) {
+      cerr << "Error: Data written during the session are not as expected." << endl;
+      return 1;
+    }
+
+    // the session file is the only open file
+    if (H5Fget_obj_count(H5F_OBJ_ALL, H5F_OBJ_FILE) != 1) {
+      cerr << "Error: Files are opened in addition to the session." << endl;
+      return 1;
+    }
+  }
+
+  if (h5_has_session(filename.c_str())) {
+    cerr << "Error: The session of '" << filename << "' still exists." << endl;
+    return 1;
+  }
+
+  vector<cl_int> values_test(LENGTH);
+  h5_read_buffer<cl_int>(filename, "data/values", &values_test[0]);
+  if (values_test != values) {
+    cerr << "Error: Data written during the session are not stored." << endl;
+    return 1;
+  }
+
+  return 0;
+}
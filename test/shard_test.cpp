@@ -0,0 +1,96 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  string filename{"shard_test.h5"};
+  char const* varname = "/data/x";
+
+  // 1003 rows of 50 floats, 200 bytes each, are split into 11 shards of 100 rows
+  vector<size_t> dims{1003, 50}, chunk_dims{32, 50};
+  size_t const shard_size = 20000, num_shards = 11;
+
+  for (size_t shard = 0; shard < num_shards; ++shard) {
+    string shard_file = "shard_test.data_x." + to_string(shard) + ".h5";
+    remove(shard_file.c_str());
+  }
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  H5_Compression compression;
+  h5_parse_compression("shuffle,deflate:1", compression);
+  h5_set_compression(compression);
+  h5_set_threads(3);
+
+  vector<float> data(dims[0] * dims[1]);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = 0.5f * (i % 3001);
+  }
+
+  h5_create_dir(filename, "/data");
+  if (!h5_write_shards(filename, varname, H5_float, &data[0], dims, chunk_dims, shard_size)) {
+    cerr << "Error: Could not write the shards of '" << varname << "'." << endl;
+    return 1;
+  }
+
+  for (size_t shard = 0; shard < num_shards; ++shard) {
+    string shard_file = "shard_test.data_x." + to_string(shard) + ".h5";
+    if (!fileExists(shard_file)) {
+      cerr << "Error: Shard file '" << shard_file << "' not found." << endl;
+      return 1;
+    }
+  }
+  if (fileExists("shard_test.data_x." + to_string(num_shards) + ".h5")) {
+    cerr << "Error: More shards than expected." << endl;
+    return 1;
+  }
+
+  // the virtual dataset reads as a single dataset
+  hid_t file_id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  hid_t dataset_id = H5Dopen(file_id, varname, H5P_DEFAULT);
+  hid_t plist_id = H5Dget_create_plist(dataset_id);
+  bool virtual_layout = H5Pget_layout(plist_id) == H5D_VIRTUAL;
+  H5Pclose(plist_id);
+
+  hid_t dataspace_id = H5Dget_space(dataset_id);
+  vector<hsize_t> dims_test(2, 0);
+  bool dims_ok = H5Sget_simple_extent_ndims(dataspace_id) == 2;
+  H5Sget_simple_extent_dims(dataspace_id, &dims_test[0], NULL);
+  dims_ok = dims_ok && dims_test[0] == dims[0] && dims_test[1] == dims[1];
+  H5Sclose(dataspace_id);
+
+  vector<float> data_test(data.size(), -1.0f);
+  bool read_ok = H5Dread(dataset_id, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &data_test[0]) >= 0;
+  H5Dclose(dataset_id);
+  H5Fclose(file_id);
+
+  if (!virtual_layout || !dims_ok) {
+    cerr << "Error: '" << varname << "' is not a virtual dataset of the expected dimensions." << endl;
+    return 1;
+  }
+  if (!read_ok || data_test != data) {
+    cerr << "Error: Data read from the virtual dataset are not as expected." << endl;
+    return 1;
+  }
+
+  // as well as through hdf5_io
+  vector<float> data_io(data.size(), -1.0f);
+  if (!h5_read_buffer<float>(filename, varname, &data_io[0]) || data_io != data) {
+    cerr << "Error: Data read by h5_read_buffer are not as expected." << endl;
+    return 1;
+  }
+
+  return 0;
+}
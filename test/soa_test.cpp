@@ -0,0 +1,131 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+// host representation of the compound dataset; split into the buffers `pos` and `id`
+struct particle {
+  double mass;
+  float pos[3];
+  cl_int id;
+};
+
+// the members stored in the output file
+struct particle_out {
+  float pos[3];
+  cl_int id;
+};
+
+
+int main(void)
+{
+  constexpr int LENGTH = 32;
+
+  string filename{"soa_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel
+  string kernel_url("soa_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void move(global float* pos, global const int* id)\n\
+{\n\
+  const int gid = get_global_id(0);\n\
+  pos[3 * gid] += id[gid];\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("move"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data
+  vector<particle> particles(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    particles.at(i).mass = 1.0;
+    particles.at(i).pos[0] = particles.at(i).pos[1] = particles.at(i).pos[2] = (float)i;
+    particles.at(i).id = i % 4;
+  }
+
+  hsize_t three = 3;
+  hid_t float3_type = H5Tarray_create2(H5T_NATIVE_FLOAT, 1, &three);
+  hid_t particle_type = H5Tcreate(H5T_COMPOUND, sizeof(particle));
+  H5Tinsert(particle_type, "mass", HOFFSET(particle, mass), H5T_NATIVE_DOUBLE);
+  H5Tinsert(particle_type, "pos", HOFFSET(particle, pos), float3_type);
+  H5Tinsert(particle_type, "id", HOFFSET(particle, id), H5T_NATIVE_INT32);
+
+  h5_create_dir(filename, "/data");
+  hid_t h5_file_id = H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  hsize_t dims[1] = { LENGTH };
+  H5LTmake_dataset(h5_file_id, "data/particles", 1, dims, particle_type, &particles[0]);
+  H5Fclose(h5_file_id);
+  h5_write_attribute_string(filename, "data/particles", "soa_fields", "pos,id");
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  hid_t particle_out_type = H5Tcreate(H5T_COMPOUND, sizeof(particle_out));
+  H5Tinsert(particle_out_type, "pos", HOFFSET(particle_out, pos), float3_type);
+  H5Tinsert(particle_out_type, "id", HOFFSET(particle_out, id), H5T_NATIVE_INT32);
+
+  vector<particle_out> particles_test(LENGTH);
+  h5_file_id = H5Fopen(out_filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  H5LTread_dataset(h5_file_id, "data/particles", particle_out_type, &particles_test[0]);
+  H5Fclose(h5_file_id);
+
+  H5Tclose(particle_out_type);
+  H5Tclose(particle_type);
+  H5Tclose(float3_type);
+
+  for (int i = 0; i < LENGTH; ++i) {
+    particle_out const& p = particles_test.at(i);
+    if (p.pos[0] != (float)(i + i % 4) || p.pos[1] != (float)i || p.pos[2] != (float)i || p.id != i % 4) {
+      cerr << "Error: Result 'particles' is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
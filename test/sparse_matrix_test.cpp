@@ -0,0 +1,73 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+#include "sparse_matrix.hpp"
+
+
+using namespace std;
+
+
+// write a matrix group with `row_name` ("row_ptr" or "row_idx") and the given datasets
+void write_group(string const& filename, string const& group, char const* row_name, vector<cl_int> const& rows,
+                 vector<cl_int> const& cols, vector<float> const& values)
+{
+  h5_create_dir(filename, group.c_str());
+  h5_write_buffer<cl_int>(filename, (group + "/" + row_name).c_str(), &rows[0], rows.size());
+  h5_write_buffer<cl_int>(filename, (group + "/col_idx").c_str(), &cols[0], cols.size());
+  h5_write_buffer<float>(filename, (group + "/values").c_str(), &values[0], values.size());
+}
+
+
+int main(void)
+{
+  string filename{"sparse_matrix_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+  h5_create_dir(filename, "/data");
+
+  vector<float> values{1.0f, 2.0f, 3.0f, 4.0f};
+  vector<cl_int> row_ptr{0, 2, 3, 4}, row_idx{0, 0, 1, 2}, cols{0, 2, 1, 2}, long_cols(4096, 0);
+
+  // valid CSR and COO matrices
+  write_group(filename, "/data/csr", "row_ptr", row_ptr, cols, values);
+  write_group(filename, "/data/coo", "row_idx", row_idx, cols, values);
+  for (char const* group : {"/data/csr", "/data/coo"}) {
+    sparse_matrix matrix;
+    if (!read_sparse_matrix(filename.c_str(), group, matrix) || matrix.num_rows != 3 || matrix.num_cols != 3
+        || matrix.row_ptr != row_ptr || matrix.col_idx != cols) {
+      cerr << "Error: The sparse matrix '" << group << "' is not read as expected." << endl;
+      return 1;
+    }
+  }
+
+  // `col_idx` longer than `values`
+  write_group(filename, "/data/csr_long_cols", "row_ptr", row_ptr, long_cols, values);
+  write_group(filename, "/data/coo_long_cols", "row_idx", row_idx, long_cols, values);
+
+  // dimensions outside of the range of int are errors rather than absent
+  write_group(filename, "/data/csr_large_rows", "row_ptr", row_ptr, cols, values);
+  h5_write_attribute<cl_ulong>(filename, "/data/csr_large_rows", "num_rows", 1ull << 40);
+  write_group(filename, "/data/coo_large_rows", "row_idx", row_idx, cols, values);
+  h5_write_attribute<cl_ulong>(filename, "/data/coo_large_rows", "num_rows", 1ull << 40);
+  write_group(filename, "/data/csr_large_cols", "row_ptr", row_ptr, cols, values);
+  h5_write_attribute<cl_ulong>(filename, "/data/csr_large_cols", "num_cols", 1ull << 40);
+
+  for (char const* group : {"/data/csr_long_cols", "/data/coo_long_cols", "/data/csr_large_rows",
+                            "/data/coo_large_rows", "/data/csr_large_cols"}) {
+    sparse_matrix matrix;
+    if (read_sparse_matrix(filename.c_str(), group, matrix)) {
+      cerr << "Error: The malformed sparse matrix '" << group << "' is accepted." << endl;
+      return 1;
+    }
+  }
+
+  return 0;
+}
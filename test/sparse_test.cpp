@@ -0,0 +1,149 @@
+/* This project is licensed under the terms of the Creative Commons CC BY-NC-ND 4.0 license. */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "opencl_include.hpp"
+#include "util.hpp"
+#include "hdf5_io.hpp"
+
+
+using namespace std;
+
+
+int main(void)
+{
+  constexpr int LENGTH = 32;
+
+  string filename{"sparse_test.h5"};
+
+  if (fileExists(filename)) {
+    remove(filename.c_str());
+  }
+
+  // kernel; `A` is bound as CSR matrix and `B` as reordered ELL matrix
+  string kernel_url("sparse_kernel.cl");
+  ofstream kernel_file;
+  kernel_file.open(kernel_url);
+  kernel_file << "\n\
+kernel void spmv(global const int* a_row_ptr, global const int* a_col_idx, global const float* a_values, uint a_rows, uint a_cols,\n\
+                 global const int* b_col_idx, global const float* b_values, global const int* b_perm, uint b_rows, uint b_cols, uint b_width,\n\
+                 global const float* x, global float* y, global float* z)\n\
+{\n\
+  const int row = get_global_id(0);\n\
+  float sum = 0.0f;\n\
+  for (int k = a_row_ptr[row]; k < a_row_ptr[row + 1]; ++k) {\n\
+    sum += a_values[k] * x[a_col_idx[k]];\n\
+  }\n\
+  y[row] = sum;\n\
+\n\
+  sum = 0.0f;\n\
+  for (uint k = 0; k < b_width; ++k) {\n\
+    const int idx = k * b_rows + row;\n\
+    sum += b_values[idx] * x[b_perm[b_col_idx[idx]]];\n\
+  }\n\
+  z[b_perm[row]] = sum;\n\
+}\n\
+" << endl;
+  kernel_file.close();
+
+  h5_create_dir(filename, "settings");
+  h5_write_string(filename, "settings/kernel_settings", "");
+  h5_write_string(filename, "kernel_url", kernel_url.c_str());
+  vector<string> kernels(1, string("spmv"));
+  h5_write_strings(filename, "kernels", kernels);
+
+  // ranges
+  cl_int tmp_range[3];
+  tmp_range[0] = LENGTH; tmp_range[1] = 1; tmp_range[2] = 1;
+  h5_write_buffer<cl_int>(filename, "settings/global_range", tmp_range, 3);
+
+  tmp_range[0] = 0; tmp_range[1] = 0; tmp_range[2] = 0;
+  h5_write_buffer<cl_int>(filename, "settings/local_range", tmp_range, 3);
+  h5_write_buffer<cl_int>(filename, "settings/range_start", tmp_range, 3);
+
+  // data: the matrix of the one dimensional Laplacian in CSR and COO format
+  vector<cl_int> row_ptr(1, 0), row_idx, col_idx;
+  vector<float> values;
+  for (int row = 0; row < LENGTH; ++row) {
+    for (int col = row - 1; col <= row + 1; ++col) {
+      if (col >= 0 && col < LENGTH) {
+        row_idx.push_back(row);
+        col_idx.push_back(col);
+        values.push_back(col == row ? 2.0f : -1.0f);
+      }
+    }
+    row_ptr.push_back(col_idx.size());
+  }
+
+  vector<float> x(LENGTH);
+  for (int i = 0; i < LENGTH; ++i) {
+    x.at(i) = (float)(i * i);
+  }
+
+  h5_create_dir(filename, "data");
+  h5_create_dir(filename, "data/A");
+  h5_write_buffer<cl_int>(filename, "data/A/row_ptr", &row_ptr[0], row_ptr.size());
+  h5_write_buffer<cl_int>(filename, "data/A/col_idx", &col_idx[0], col_idx.size());
+  h5_write_buffer<float>(filename, "data/A/values", &values[0], values.size());
+  h5_write_attribute<cl_int>(filename, "data/A", "num_rows", LENGTH);
+  h5_write_attribute<cl_int>(filename, "data/A", "num_cols", LENGTH);
+
+  h5_create_dir(filename, "data/B");
+  h5_write_buffer<cl_int>(filename, "data/B/row_idx", &row_idx[0], row_idx.size());
+  h5_write_buffer<cl_int>(filename, "data/B/col_idx", &col_idx[0], col_idx.size());
+  h5_write_buffer<float>(filename, "data/B/values", &values[0], values.size());
+  h5_write_attribute_string(filename, "data/B", "sparse_format", "ell");
+  h5_write_attribute_string(filename, "data/B", "sparse_reorder", "rcm");
+
+  h5_write_buffer<float>(filename, "data/x", &x[0], LENGTH);
+  h5_create_buffer<float>(filename, "data/y", LENGTH, 0.0f);
+  h5_create_buffer<float>(filename, "data/z", LENGTH, 0.0f);
+
+
+  // call toolkitICL
+  string command("toolkitICL -c ");
+  command.append(filename);
+  int retval = system(command.c_str());
+  if (retval) {
+    cerr << "Error: " << retval << endl;
+    return 1;
+  }
+
+
+  // check result
+  string out_filename("out_");
+  out_filename.append(filename);
+
+  if (!fileExists(out_filename)) {
+    cerr << "Error: File " << out_filename << " not found." << endl;
+    return 1;
+  }
+
+  vector<float> y(LENGTH), z(LENGTH);
+  h5_read_buffer<float>(out_filename, "data/y", &y[0]);
+  h5_read_buffer<float>(out_filename, "data/z", &z[0]);
+
+  for (int i = 0; i < LENGTH; ++i) {
+    float expected = 2.0f * x.at(i) - (i > 0 ? x.at(i - 1) : 0.0f) - (i + 1 < LENGTH ? x.at(i + 1) : 0.0f);
+    if (y.at(i) != expected) {
+      cerr << "Error: Result 'y' of the CSR matrix is not as expected." << endl;
+      return 1;
+    }
+    if (z.at(i) != expected) {
+      cerr << "Error: Result 'z' of the ELL matrix is not as expected." << endl;
+      return 1;
+    }
+  }
+
+  // the matrices are linked to the input file
+  vector<cl_int> row_ptr_test(LENGTH + 1);
+  h5_read_buffer<cl_int>(out_filename, "data/A/row_ptr", &row_ptr_test[0]);
+  if (row_ptr_test != row_ptr) {
+    cerr << "Error: Matrix 'A' is not stored as expected." << endl;
+    return 1;
+  }
+
+  return 0;
+}